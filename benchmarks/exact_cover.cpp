@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+// Time counting every exact cover of classic instances, separating the
+// building of the cover matrix from the search: the n-queens problem
+// and the packings of the twelve pentominoes into rectangles.
+//
+// Usage: benchmark_exact_cover [repetitions]
+//
+// Without a count of repetitions, the 4x15 packings, which take
+// seconds to count, are only counted once.
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "exact_cover.hpp"
+#include "mapped_matrix.hpp"
+#include "harness.hpp"
+#include "tests/fixtures.hpp"
+
+using namespace std;
+
+typedef vector<pair<int, int> > Shape;
+
+// Cells of the twelve pentominoes, F I L N P T U V W X Y Z.
+const int pentominoes[12][10] = {
+    { 1, 0, 2, 0, 0, 1, 1, 1, 1, 2 }, { 0, 0, 0, 1, 0, 2, 0, 3, 0, 4 },
+    { 0, 0, 0, 1, 0, 2, 0, 3, 1, 3 }, { 0, 0, 0, 1, 1, 1, 1, 2, 1, 3 },
+    { 0, 0, 1, 0, 0, 1, 1, 1, 0, 2 }, { 0, 0, 1, 0, 2, 0, 1, 1, 1, 2 },
+    { 0, 0, 2, 0, 0, 1, 1, 1, 2, 1 }, { 0, 0, 0, 1, 0, 2, 1, 2, 2, 2 },
+    { 0, 0, 0, 1, 1, 1, 1, 2, 2, 2 }, { 1, 0, 0, 1, 1, 1, 2, 1, 1, 2 },
+    { 1, 0, 0, 1, 1, 1, 1, 2, 1, 3 }, { 0, 0, 1, 0, 1, 1, 1, 2, 2, 2 }
+};
+
+// Distinct rotations and reflections of a pentomino,
+// each moved against the origin with its cells sorted.
+set<Shape> orientations(const int* cells) {
+    set<Shape> shapes;
+    for (int t = 0; t < 8; t++) {
+        Shape shape;
+        for (int i = 0; i < 5; i++) {
+            int x = cells[2 * i], y = cells[2 * i + 1];
+            if (t & 1) x = -x;
+            if (t & 2) y = -y;
+            if (t & 4) swap(x, y);
+            shape.push_back(make_pair(x, y));
+        }
+
+        int dx = shape[0].first, dy = shape[0].second;
+        for (int i = 1; i < 5; i++) {
+            dx = min(dx, shape[i].first);
+            dy = min(dy, shape[i].second);
+        }
+        for (int i = 0; i < 5; i++) {
+            shape[i].first -= dx;
+            shape[i].second -= dy;
+        }
+        sort(shape.begin(), shape.end());
+        shapes.insert(shape);
+    }
+    return shapes;
+}
+
+// Encode the packings of the pentominoes into a rectangle of 60 cells.
+// A row places a piece somewhere on the board, covering the column of
+// the piece and those of its cells.
+MappedMatrix<int> pentomino_packing(int width, int height) {
+    vector<vector<uint32> > placements;
+    for (int piece = 0; piece < 12; piece++) {
+        set<Shape> shapes = orientations(pentominoes[piece]);
+        for (set<Shape>::const_iterator it = shapes.begin(); it != shapes.end(); ++it) {
+            for (int x = 0; x < width; x++) {
+                for (int y = 0; y < height; y++) {
+                    vector<uint32> cols(1, piece);
+                    for (int i = 0; i < 5; i++) {
+                        int cx = x + (*it)[i].first, cy = y + (*it)[i].second;
+                        if (cx < width && cy < height) {
+                            cols.push_back(12 + cy * width + cx);
+                        }
+                    }
+                    if (cols.size() == 6) {
+                        placements.push_back(cols);
+                    }
+                }
+            }
+        }
+    }
+
+    MappedMatrix<int> matrix(placements.size(), 12 + width * height);
+    for (uint32 row = 0; row < placements.size(); row++) {
+        for (size_t i = 0; i < placements[row].size(); i++) {
+            matrix(row, placements[row][i]) = 1;
+        }
+    }
+    return matrix;
+}
+
+// Time building the cover matrix of an instance and
+// counting its exact covers, once per repetition.
+template <typename Matrix>
+void run(const string& workload, const Matrix& matrix, uint64 expected,
+         uint32 repetitions) {
+    benchmark::Samples build_times;
+    benchmark::Samples search_times;
+    exact_cover::Arena arena;
+
+    for (uint32 i = 0; i < repetitions; i++) {
+        benchmark::clock::time_point start = benchmark::clock::now();
+        exact_cover::Search search(matrix, arena);
+        build_times.add(benchmark::since(start));
+
+        start = benchmark::clock::now();
+        uint64 covers = 0;
+        while (search.next()) {
+            covers++;
+        }
+        search_times.add(benchmark::since(start));
+
+        benchmark::check(covers == expected, workload);
+    }
+
+    benchmark::report(workload, "build", build_times);
+    benchmark::report(workload, "search", search_times);
+}
+
+int main(int argc, char* argv[]) {
+    uint32 repetitions = benchmark::repetitions(argc, argv, 5);
+    uint32 long_repetitions = benchmark::repetitions(argc, argv, 1);
+
+    const uint64 queens_counts[] = { 92, 352, 724, 2680 };
+    for (uint32 n = 8; n <= 11; n++) {
+        ostringstream workload;
+        workload << "queens_" << n;
+        MappedMatrix<int> board = queens(n);
+        run(workload.str(), exact_cover::primary_columns(board, 2 * n),
+            queens_counts[n - 8], repetitions);
+    }
+
+    // Packings of each rectangle, counting reflections and rotations.
+    run("pentominoes_3x20", pentomino_packing(20, 3), 8, repetitions);
+    run("pentominoes_4x15", pentomino_packing(15, 4), 1472, long_repetitions);
+
+    return 0;
+}
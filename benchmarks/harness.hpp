@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef BENCHMARKS_HARNESS_HPP_
+#define BENCHMARKS_HARNESS_HPP_
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include "types.hpp"
+
+namespace benchmark {
+
+typedef std::chrono::steady_clock clock;
+
+// Milliseconds elapsed since a given time.
+inline double since(clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+}
+
+// Times taken by a phase of a workload, one per repetition.
+class Samples {
+public:
+    void add(double milliseconds) { times.push_back(milliseconds); }
+
+    double min() const { return *std::min_element(times.begin(), times.end()); }
+    double max() const { return *std::max_element(times.begin(), times.end()); }
+
+    double median() const {
+        std::vector<double> sorted(times);
+        std::sort(sorted.begin(), sorted.end());
+        size_t middle = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[middle]
+                                 : (sorted[middle - 1] + sorted[middle]) / 2;
+    }
+
+    double mean() const {
+        double sum = 0;
+        for (size_t i = 0; i < times.size(); i++) {
+            sum += times[i];
+        }
+        return sum / times.size();
+    }
+
+    double stddev() const {
+        double average = mean();
+        double sum = 0;
+        for (size_t i = 0; i < times.size(); i++) {
+            sum += (times[i] - average) * (times[i] - average);
+        }
+        return times.size() > 1 ? std::sqrt(sum / (times.size() - 1)) : 0;
+    }
+
+    size_t size() const { return times.size(); }
+
+private:
+    std::vector<double> times;
+};
+
+// Report the samples of a phase of a workload: a line of JSON on the
+// standard output, meant to be tracked across changes, and a line
+// for humans on the standard error.
+inline void report(const std::string& workload, const std::string& phase,
+                   const Samples& samples) {
+    std::cout << "{\"workload\": \"" << workload << "\", \"phase\": \"" << phase
+              << "\", \"repetitions\": " << samples.size()
+              << ", \"min_ms\": " << samples.min()
+              << ", \"median_ms\": " << samples.median()
+              << ", \"mean_ms\": " << samples.mean()
+              << ", \"max_ms\": " << samples.max()
+              << ", \"stddev_ms\": " << samples.stddev() << "}" << std::endl;
+
+    std::cerr << workload << " " << phase << ": median " << samples.median()
+              << " ms, min " << samples.min() << " ms, stddev "
+              << samples.stddev() << " ms" << std::endl;
+}
+
+// Stop the benchmark if a workload gave a wrong result.
+inline void check(bool condition, const std::string& workload) {
+    if (!condition) {
+        std::cerr << workload << ": wrong result!" << std::endl;
+        std::exit(1);
+    }
+}
+
+// Number of repetitions, given as the only argument of a benchmark.
+inline uint32 repetitions(int argc, char* argv[], uint32 fallback) {
+    if (argc > 1) {
+        int count = std::atoi(argv[1]);
+        if (count > 0) {
+            return count;
+        }
+    }
+    return fallback;
+}
+
+} // namespace benchmark
+
+#endif // BENCHMARKS_HARNESS_HPP_
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+// Time the sudoku solvers, separating the encoding of grids into
+// binary matrices, the building of the cover matrices and the search.
+// This file is built twice: once against sudoku_solver_ng.hpp and
+// once, with CLASSIC_SOLVER defined, against sudoku_solver.hpp. Both
+// headers define the same functions, so they can't share a program.
+//
+// Usage: benchmark_sudoku [repetitions]
+
+#include <string>
+#include <vector>
+
+#include "sudoku.hpp"
+#include "exact_cover.hpp"
+#include "harness.hpp"
+
+#ifdef CLASSIC_SOLVER
+#include "power.hpp"
+#include "mapped_matrix.hpp"
+#include "sudoku_solver.hpp"
+#else
+#include "sudoku_solver_ng.hpp"
+#endif
+
+using namespace std;
+using namespace sudoku;
+
+#ifdef CLASSIC_SOLVER
+const string solver = "classic";
+
+// The binary matrix of a grid, as built by sudoku_solver.hpp.
+template <uint16 Row, uint16 Col>
+struct Instance {
+    explicit Instance(const Grid<Row, Col>& grid) :
+        matrix(power<Grid<Row, Col>::size, 3>::value,
+               power<Grid<Row, Col>::size, 2>::value * 4) {
+        encode(grid, matrix, index);
+    }
+
+    // Cells left out of the matrix.
+    uint32 known() const { return 0; }
+
+    MappedMatrix<bool> matrix;
+    CoverIndex index;
+};
+#else
+const string solver = "ng";
+
+// The binary matrix of a grid, as built by sudoku_solver_ng.hpp.
+template <uint16 Row, uint16 Col>
+struct Instance {
+    explicit Instance(const Grid<Row, Col>& grid) {
+        matrix << grid;
+    }
+
+    // Cells left out of the matrix, filled by propagation.
+    uint32 known() const {
+        uint32 cells = 0;
+        for (uint16 row = 0; row < Grid<Row, Col>::size; row++) {
+            for (uint16 col = 0; col < Grid<Row, Col>::size; col++) {
+                cells += matrix.known()(row, col).setted();
+            }
+        }
+        return cells;
+    }
+
+    SudokuBinaryMatrix<Row, Col> matrix;
+};
+#endif
+
+// Hard 9x9 puzzles with a single solution each, values counting from 0.
+const char* hard[] = {
+    "0xxxx6x8xx2xx1xxx7xx85xx4xxxx42xx8xxx0xx7xxx15xxxx3xxx2xxxxxx0xx3xxxxxx6xx6xxx2xx",
+    "7xxxxxxxxxx25xxxxxx6xx8x1xxx4xxx6xxxxxxx346xxxxx0xxx2xxx0xxxx57xx74xxx0xx8xxxx3xx",
+    "0xxxxxxx1x8x3xxx4xxx5xxx6xxx4x8x2xxxxxxx6xxxxxxx74xx3x6xxxxx5xxx2xxx8x7xxx1xxxxx0",
+    "3xxxxx7x4x2xxxxxxxxxx6xxxxxx1xxxxx5xxxxx7x3xxxxxx0xxxxxxx5x2x6x4xx1xxxxx0x3xxxxxx",
+    "41xxx5xxxxxxxxx6x02xxxxxxxxxxx3xx7xx5xxxxxx4xxxxxxxxxxx307xxxxxxxxx2xx1xxx76xxxxx",
+    "5xxxxx7x2x3x6xxxxxxxxxxxxxxxxx4x3x6x2xx1xxxxx0x5xxxxxxx1xxxxx4xxxxx7x5xxxxxx0xxxx",
+    "37x2xxxxxxxxxxxx60x1xxxxxxx6x4xxxx5xxxx1xx7xxxxxxxxxxxxx0x65xxx2xxxxx3xxxxxx4xxxx"
+};
+
+// A 16x16 puzzle, see tests/sudoku_solver_ng.cpp.
+const char* puzzle16 =
+    "x43xCxxxAxxx19xx" "xx7xx9xA1xxxxxx4" "810xDBxxxCxxxx5x" "xF5Axx4xx63xx70x"
+    "x0xx9x26x874xDxB" "xxxxA8xxxxEDxxx3" "xxx4xxxxxxA6817x" "xxx8xxxD20xxxxA5"
+    "2Exxxx784xxxAxxx" "xA452CxxxxxxBxxx" "0xxxBExxxxxxxxxx" "1xCx43DxE5xAxx2x"
+    "x5Axx2Exx9xx7BDx" "x7xxxx1xxx2Fx43E" "3xxxxxx5Cx6xx8xx" "xx8ExxxFxxxBxxxx";
+
+// Time every phase of solving a set of grids, once per repetition.
+template <uint16 Row, uint16 Col>
+void run(const string& workload, const vector<Grid<Row, Col> >& grids,
+         uint32 repetitions) {
+    benchmark::Samples encode_times;
+    benchmark::Samples build_times;
+    benchmark::Samples search_times;
+    exact_cover::Arena arena;
+
+    for (uint32 i = 0; i < repetitions; i++) {
+        double encode = 0, build = 0, search = 0;
+        for (size_t j = 0; j < grids.size(); j++) {
+            benchmark::clock::time_point start = benchmark::clock::now();
+            Instance<Row, Col> instance(grids[j]);
+            encode += benchmark::since(start);
+
+            start = benchmark::clock::now();
+            exact_cover::Search cover_search(instance.matrix, arena);
+            build += benchmark::since(start);
+
+            start = benchmark::clock::now();
+            bool solved = cover_search.next();
+            search += benchmark::since(start);
+
+            benchmark::check(solved && cover_search.cover().size() + instance.known() ==
+                             Grid<Row, Col>::num_cells, workload);
+        }
+        encode_times.add(encode);
+        build_times.add(build);
+        search_times.add(search);
+    }
+
+    benchmark::report(solver + "/" + workload, "encode", encode_times);
+    benchmark::report(solver + "/" + workload, "build", build_times);
+    benchmark::report(solver + "/" + workload, "search", search_times);
+}
+
+int main(int argc, char* argv[]) {
+    uint32 repetitions = benchmark::repetitions(argc, argv, 10);
+
+    vector<Grid<3, 3> > grids9(sizeof(hard) / sizeof(hard[0]));
+    for (size_t i = 0; i < grids9.size(); i++) {
+        grids9[i] << hard[i];
+    }
+    run("9x9_hard", grids9, repetitions);
+
+    vector<Grid<4, 4> > grids16(1);
+    grids16[0] << puzzle16;
+    run("16x16_puzzle", grids16, repetitions);
+    run("16x16_empty", vector<Grid<4, 4> >(1), repetitions);
+    run("25x25_empty", vector<Grid<5, 5> >(1), repetitions);
+
+    return 0;
+}
@@ -18,13 +18,182 @@
 #ifndef EXACT_COVER_SOLVER_HPP_
 #define EXACT_COVER_SOLVER_HPP_
 
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <random>
+#include <chrono>
+#include <atomic>
 #include <vector>
 #include <limits>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "types.hpp"
 
 namespace exact_cover {
 
+// A lightweight view over the rows of a cover, as handed to the
+// visitors of enumerate(). It points into the solver's own storage
+// and is only valid for the duration of the visitor call.
+class CoverView {
+public:
+    typedef const uint32* const_iterator;
+
+    CoverView(const_iterator first, const_iterator last) :
+        first(first), last(last) {}
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return last; }
+
+    size_t size() const { return last - first; }
+    uint32 operator[](size_t i) const { return first[i]; }
+
+private:
+    const_iterator first, last;
+};
+
+namespace details {
+
+struct Node;
+
+} // namespace details
+
+// Base of the column selection policies given as template argument
+// to BasicSearch. A policy is a class with a choose(root) member
+// returning the next column to cover among those still linked to the
+// root, which holds at least one. Policies are held by value and
+// called directly, so a user-defined one gets inlined in the search.
+//
+// The hooks below are called as the search covers and uncovers
+// columns: initialize() once the cover matrix is built, hide() and
+// unhide() when a column leaves and rejoins the root list, and
+// decrement() and increment() after the size of a column changed.
+// They do nothing and compile away unless a policy overrides them
+// to maintain some state of its own.
+struct ColumnPolicy {
+    void initialize(details::Node*) {}
+    void hide(details::Node*) {}
+    void unhide(details::Node*) {}
+    void decrement(details::Node*) {}
+    void increment(details::Node*) {}
+};
+
+// Statistics gathered by a search, given as template argument to
+// BasicSearch. A search notifies its statistics of every node of the
+// search tree it enters, at a given depth, and of every link update,
+// i.e. every node removed from or restored to the cover matrix.
+// NullStats ignores them and compiles away, so statistics only cost
+// something in the searches asking for them.
+struct NullStats {
+    void enter(size_t) {}
+    void update() {}
+};
+
+// Count the work done by a search, which unlike its running time
+// doesn't depend on the machine. Nodes include the root of the
+// search tree and its leaves, solutions or dead ends, and profile
+// holds the number of nodes entered at each depth.
+struct SearchStats {
+    SearchStats() : nodes(0), updates(0), max_depth(0) {}
+
+    void enter(size_t depth) {
+        nodes++;
+        if (depth >= profile.size()) {
+            profile.resize(depth + 1);
+        }
+        profile[depth]++;
+        max_depth = std::max(max_depth, depth);
+    }
+
+    void update() {
+        updates++;
+    }
+
+    uint64 nodes;                   // Nodes of the search tree entered.
+    uint64 updates;                 // Links updated in the cover matrix.
+    size_t max_depth;               // Depth of the deepest node.
+    std::vector<uint64> profile;    // Nodes entered at each depth.
+};
+
+// Limits on the work of a search: a number of nodes of the search
+// tree, a deadline and a flag set from another thread to cancel the
+// search. The node count is checked at every node, while the clock
+// and the flag are costlier and only checked at the first node and
+// every few thousand nodes after. A budget without limits never
+// runs out.
+class Budget {
+public:
+    typedef std::chrono::steady_clock clock;
+
+    Budget() : nodes(std::numeric_limits<uint64>::max()), timed(false),
+        flag(0), countdown(1), spent(false) {}
+
+    // Stop the search after entering the given number of nodes.
+    Budget& node_limit(uint64 nodes) {
+        this->nodes = nodes;
+        return *this;
+    }
+
+    // Stop the search once the deadline has passed.
+    Budget& deadline(clock::time_point deadline) {
+        timed = true;
+        until = deadline;
+        return *this;
+    }
+
+    // Stop the search once the flag is set. The flag must
+    // outlive the searches using the budget.
+    Budget& cancellation(const std::atomic<bool>& flag) {
+        this->flag = &flag;
+        return *this;
+    }
+
+    // Charge a node to the budget. Returns false, and keeps doing
+    // so, once the budget has run out.
+    bool charge() {
+        if (nodes == 0) {
+            spent = true;
+            return false;
+        }
+        nodes--;
+
+        if (--countdown == 0) {
+            countdown = interval;
+            if ((flag != 0 && flag->load(std::memory_order_relaxed)) ||
+                (timed && clock::now() >= until)) {
+                nodes = 0;
+                spent = true;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Whether a search was stopped for lack of budget.
+    bool exhausted() const { return spent; }
+
+private:
+    // Nodes entered between two checks of the clock and the flag.
+    static const uint32 interval = 4096;
+
+    uint64 nodes;                       // Nodes left to enter.
+    bool timed;                         // Whether there is a deadline.
+    clock::time_point until;            // Deadline of the search.
+    const std::atomic<bool>* flag;      // Cancellation flag, if any.
+    uint32 countdown;                   // Nodes left until the next check.
+    bool spent;                         // Whether the budget ran out.
+};
+
+// Outcome of a search under a budget.
+enum Status {
+    SOLVED,         // A cover was found.
+    UNSOLVABLE,     // The search ended without finding a cover.
+    EXHAUSTED       // The budget ran out before the search ended.
+};
+
 namespace details {
 
 // A node contains pointer to all of its neighbors (left,
@@ -40,9 +209,40 @@ struct Node {
     uint32 data;
 };
 
+// Storage for the nodes of a cover matrix. Every node is carved
+// out of a single contiguous block sized from the number of nonzeros
+// found in the binary matrix, so building a cover matrix costs one
+// bulk allocation and tearing it down costs one bulk free. Since the
+// storage only ever grows, an arena kept alive across solves lets a
+// steady-state workload run without touching the heap at all.
+struct NodeArena {
+    NodeArena() : used(0) {}
+
+    // Discard every node handed out so far and make room for
+    // count nodes, reallocating only if the block is too small.
+    void reset(size_t count) {
+        if (nodes.size() < count) {
+            std::vector<Node>(count).swap(nodes);
+        }
+        used = 0;
+    }
+
+    Node* allocate() {
+        return &nodes[used++];
+    }
+
+    std::vector<Node> nodes;        // Node storage, root first.
+    size_t used;                    // Nodes handed out since the last reset.
+    std::vector<uint32> columns;    // Scratch: nonzero columns, row by row.
+    std::vector<uint32> offsets;    // Scratch: start of each row in columns.
+    std::vector<uint32> partial;    // Scratch: rows of the cover being searched.
+    std::vector<Node*> choices;     // Scratch: element tried at each level.
+    std::vector<bool> covered;      // Scratch: columns covered by forced rows.
+};
+
 // Allocate and initialize the cover matrix root.
-Node* build_root() {
-    Node* root = new Node;
+inline Node* build_root(NodeArena& arena) {
+    Node* root = arena.allocate();
     root->down = root;
     root->up = root;
     root->left = root;
@@ -50,96 +250,46 @@ Node* build_root() {
     return root;
 }
 
-// Allocate and initialize cover matrix column headers.
-std::vector<Node*> build_column_headers(Node* root, size_t cols) {
-    std::vector<Node*> headers(cols);
+// Allocate and initialize cover matrix column headers. Headers
+// are allocated contiguously, so the returned pointer can be
+// indexed by column to retrieve the associated header. Only the
+// first primary headers are linked to the root: the others are
+// secondary columns, which never get chosen by the search.
+inline Node* build_column_headers(Node* root, size_t cols, size_t primary,
+                                  NodeArena& arena) {
+    Node* headers = arena.nodes.data() + arena.used;
 
     Node* predecessor = root;
     for (size_t i = 0; i < cols; ++i) {
-        headers[i] = new Node;
-        headers[i]->up = headers[i];
-        headers[i]->down = headers[i];
-        headers[i]->left = predecessor;
-        headers[i]->right = root;
-        headers[i]->data = 0;
-
-        // Update immediate neighbors.
-        root->left = headers[i];
-        predecessor->right = headers[i];
-
-        // Update predecessor for next iteration.
-        predecessor = headers[i];
-    }
-
-    return headers;
-}
+        Node* header = arena.allocate();
+        header->up = header;
+        header->down = header;
+        header->header = header;
+        header->data = 0;
 
-// Allocate and initialize cover matrix row headers.
-std::vector<Node*> build_row_headers(Node* root, size_t rows) {
-    std::vector<Node*> headers(rows);
+        if (i >= primary) {
+            header->left = header;
+            header->right = header;
+            continue;
+        }
 
-    Node* predecessor = root;
-    for (size_t i = 0; i < rows; i++) {
-        headers[i] = new Node;
-        headers[i]->up = predecessor;
-        headers[i]->down = root;
-        headers[i]->left = headers[i];
-        headers[i]->right = headers[i];
+        header->left = predecessor;
+        header->right = root;
 
         // Update immediate neighbors.
-        root->up = headers[i];
-        predecessor->down = headers[i];
+        root->left = header;
+        predecessor->right = header;
 
         // Update predecessor for next iteration.
-        predecessor = headers[i];
+        predecessor = header;
     }
 
     return headers;
 }
 
-// Remove and deallocate row headers from the newly
-// constructed cover matrix.
-void delete_row_headers(std::vector<Node*>& headers) {
-    typedef std::vector<Node*>::size_type size_type;
-    for (size_type i = 0; i < headers.size(); i++) {
-        Node* header = headers[i];
-        header->left->right = header->right;
-        header->right->left = header->left;
-        header->up->down = header->down;
-        header->down->up = header->up;
-        delete header;
-    }
-}
-
-// Given the root node, deallocate the cover matrix.
-void delete_cover_matrix(Node* root) {
-    Node* header = root->right;
-    Node* old, *node;
-
-    // Go over each header of the cover matrix.
-    while (header != root) {
-        node = header->down;
-
-        // Deallocate each element in the
-        // column associated to this header.
-        while (node != header) {
-            old = node;
-            node = node->down;
-            delete old;
-        }
-
-        // Deallocate the header.
-        old = header;
-        header = header->right;
-        delete old;
-    }
-
-    delete root;
-}
-
 // Choose the next column to cover based on some heuristic,
 // e.g. the number of elements contained in a column.
-Node* choose_next_column(Node* root)  {
+inline Node* choose_next_column(Node* root)  {
     uint32 lower = std::numeric_limits<uint32>::max();
 
     Node* current = root->right;
@@ -156,10 +306,14 @@ Node* choose_next_column(Node* root)  {
     return next;
 }
 
-// Given an header node, cover the associated column.
-void cover_column(Node* header) {
+// Given an header node, cover the associated column. The policy
+// is notified of every change to the set of columns and to their
+// sizes, see ColumnPolicy.
+template <typename Policy>
+void cover_column(Node* header, Policy& policy) {
     header->left->right = header->right;
     header->right->left = header->left;
+    policy.hide(header);
 
     Node* col = header->down;
     while (col != header) {
@@ -168,6 +322,7 @@ void cover_column(Node* header) {
             row->up->down = row->down;
             row->down->up = row->up;
             row->header->data--;
+            policy.decrement(row->header);
             row = row->right;
         }
         col = col->down;
@@ -175,7 +330,8 @@ void cover_column(Node* header) {
 }
 
 // Given an header node, uncover the associated column.
-void uncover_column(Node* header) {
+template <typename Policy>
+void uncover_column(Node* header, Policy& policy) {
     Node* col = header->up;
 
     while (col != header) {
@@ -184,6 +340,7 @@ void uncover_column(Node* header) {
             row->up->down = row;
             row->down->up = row;
             row->header->data++;
+            policy.increment(row->header);
             row = row->left;
         }
         col = col->up;
@@ -191,117 +348,1576 @@ void uncover_column(Node* header) {
 
     header->left->right = header;
     header->right->left = header;
+    policy.unhide(header);
+}
+
+// Given an element of a column, cover the other columns of its row.
+template <typename Policy>
+void cover_row(Node* element, Policy& policy) {
+    Node* row = element->right;
+    while (row != element) {
+        cover_column(row->header, policy);
+        row = row->right;
+    }
+}
+
+// Given an element of a column, uncover the other columns of its
+// row, in the reverse order in which cover_row covered them.
+template <typename Policy>
+void uncover_row(Node* element, Policy& policy) {
+    Node* row = element->left;
+    while (row != element) {
+        uncover_column(row->header, policy);
+        row = row->left;
+    }
+}
+
+// A column policy also notifying search statistics of the link
+// updates, so that covering and uncovering needn't know about them.
+template <typename Policy, typename Stats>
+struct Instrumented {
+    explicit Instrumented(const Policy& policy) : policy(policy) {}
+
+    Node* choose(Node* root) {
+        return policy.choose(root);
+    }
+
+    void initialize(Node* root) {
+        policy.initialize(root);
+    }
+
+    void hide(Node* header) {
+        stats.update();
+        policy.hide(header);
+    }
+
+    void unhide(Node* header) {
+        stats.update();
+        policy.unhide(header);
+    }
+
+    void decrement(Node* header) {
+        stats.update();
+        policy.decrement(header);
+    }
+
+    void increment(Node* header) {
+        stats.update();
+        policy.increment(header);
+    }
+
+    Policy policy;
+    Stats stats;
+};
+
+// Tells whether a binary matrix exposes the nonzero columns of its
+// rows. Such a matrix defines a nonzero_iterator type, dereferencing
+// to a column index, along with nonzero_begin(row) and nonzero_end(row)
+// members delimiting the nonzero columns of a row.
+template <typename Matrix>
+class is_sparse {
+    typedef char yes[1];
+    typedef char no[2];
+
+    template <typename M>
+    static yes& test(typename M::nonzero_iterator*);
+
+    template <typename M>
+    static no& test(...);
+
+public:
+    static const bool value = sizeof(test<Matrix>(0)) == sizeof(yes);
+};
+
+// Tells whether a binary matrix declares how many of its columns are
+// primary, through a primary_cols() member, possibly inherited and
+// returning any integer. Primary columns come first and must be
+// covered exactly once, while the remaining secondary columns may be
+// covered at most once.
+template <typename Matrix>
+class has_primary_cols {
+    typedef char yes[1];
+    typedef char no[2];
+
+    template <typename M>
+    static yes& test(decltype(static_cast<uint32>(
+        std::declval<const M&>().primary_cols()))*);
+
+    template <typename M>
+    static no& test(...);
+
+public:
+    static const bool value = sizeof(test<Matrix>(0)) == sizeof(yes);
+};
+
+template <bool Primary>
+struct primary_tag {};
+
+template <typename Matrix>
+uint32 primary_cols(const Matrix& matrix, primary_tag<true>) {
+    return matrix.primary_cols();
+}
+
+template <typename Matrix>
+uint32 primary_cols(const Matrix& matrix, primary_tag<false>) {
+    return matrix.cols();
+}
+
+// Number of primary columns of a binary matrix, which are all
+// of its columns unless it declares otherwise.
+template <typename Matrix>
+uint32 primary_cols(const Matrix& matrix) {
+    return primary_cols(matrix, primary_tag<has_primary_cols<Matrix>::value>());
+}
+
+template <bool Sparse>
+struct sparse_tag {};
+
+// Record the nonzero columns of a matrix row by probing every column.
+template <typename Matrix>
+void collect_row(const Matrix& matrix, uint32 row,
+                 std::vector<uint32>& columns, sparse_tag<false>) {
+    for (uint32 col = 0; col < matrix.cols(); col++) {
+        if (matrix(row, col)) {
+            columns.push_back(col);
+        }
+    }
+}
+
+// Record the nonzero columns of a sparse matrix row.
+template <typename Matrix>
+void collect_row(const Matrix& matrix, uint32 row,
+                 std::vector<uint32>& columns, sparse_tag<true>) {
+    typename Matrix::nonzero_iterator iter = matrix.nonzero_begin(row);
+    typename Matrix::nonzero_iterator end = matrix.nonzero_end(row);
+    for (; iter != end; ++iter) {
+        columns.push_back(*iter);
+    }
 }
 
-// The actual recursive procedure implementing the dancing links
-// algorithm. Indexes of the rows forming the exact cover will
-// be appended to the cover vector if a solution is found.
-bool solve(Node* root, std::vector<uint32>& cover) {
+// Record the nonzero columns of each row of a binary matrix.
+// Columns of row i are stored in columns[offsets[i]] up to
+// columns[offsets[i + 1]], exclusively. Sparse matrices are
+// walked through their nonzeros, others are probed densely.
+template <typename Matrix>
+void collect_nonzeros(const Matrix& matrix, std::vector<uint32>& columns,
+                      std::vector<uint32>& offsets) {
+    columns.clear();
+    offsets.clear();
+
+    for (uint32 row = 0; row < matrix.rows(); row++) {
+        offsets.push_back(columns.size());
+        collect_row(matrix, row, columns, sparse_tag<is_sparse<Matrix>::value>());
+    }
+
+    offsets.push_back(columns.size());
+}
+
+// Initialize the cover matrix for a given binary matrix inside
+// the given arena. The cover matrix lives as long as the arena
+// isn't reset, there is no need to deallocate it explicitly.
+template <typename Matrix>
+Node* build_cover_matrix(const Matrix& matrix, NodeArena& arena)  {
+    collect_nonzeros(matrix, arena.columns, arena.offsets);
+    arena.reset(1 + matrix.cols() + arena.columns.size());
+
+    Node* root = build_root(arena);
+    Node* headers = build_column_headers(root, matrix.cols(),
+                                         primary_cols(matrix), arena);
+
+    for (size_t row = 0; row < matrix.rows(); row++) {
+        Node* row_first = 0;
+
+        for (size_t i = arena.offsets[row]; i < arena.offsets[row + 1]; i++) {
+            Node* header = &headers[arena.columns[i]];
+
+            // Initialize new node.
+            Node* node = arena.allocate();
+            node->header = header;
+            node->up = header->up;
+            node->down = header;
+            node->data = row;
+
+            // Update column neighbors.
+            node->up->down = node;
+            header->up = node;
+            header->data++;
+
+            // Append the node to the circular list of its row.
+            if (row_first == 0) {
+                node->left = node;
+                node->right = node;
+                row_first = node;
+            } else {
+                node->left = row_first->left;
+                node->right = row_first;
+                row_first->left->right = node;
+                row_first->left = node;
+            }
+        }
+    }
+
+    return root;
+}
+
+// A compact alternative to the pointer based cover matrix, laid
+// out as in Knuth's DLX1. Links are 32-bit indexes stored in
+// separate arrays, which is about 12 bytes per nonzero instead of
+// 48. Nodes of a row are stored consecutively and delimited by
+// spacer nodes, so left and right links aren't needed.
+//
+// Index 0 is the root and indexes 1 to cols are the column headers,
+// which are the only nodes with horizontal links. The top field of
+// a header holds the number of elements in its column, the one of
+// a nonzero the index of its header. The top field of a spacer is
+// negated row index of the row which follows it, its up link points
+// to the first node of the preceding row and its down link to the
+// last node of the following row.
+struct CompactCoverMatrix {
+    std::vector<uint32> llink, rlink;   // Horizontal links of headers.
+    std::vector<int32> top;             // Header, size or spacer tag.
+    std::vector<uint32> ulink, dlink;   // Vertical links of all nodes.
+    std::vector<uint32> columns;        // Scratch: nonzero columns, row by row.
+    std::vector<uint32> offsets;        // Scratch: start of each row in columns.
+};
+
+// Initialize the compact cover matrix for a given binary matrix.
+// Storage of the compact matrix is reused if it's large enough.
+template <typename Matrix>
+void build_cover_matrix(const Matrix& matrix, CompactCoverMatrix& m) {
+    collect_nonzeros(matrix, m.columns, m.offsets);
+
+    uint32 cols = matrix.cols();
+    uint32 spacers = 1;
+    for (size_t row = 0; row < matrix.rows(); row++) {
+        spacers += m.offsets[row] != m.offsets[row + 1];
+    }
+
+    size_t size = cols + 1 + m.columns.size() + spacers;
+    m.llink.resize(cols + 1);
+    m.rlink.resize(cols + 1);
+    m.top.resize(size);
+    m.ulink.resize(size);
+    m.dlink.resize(size);
+
+    // Link the root and primary column headers in a circular
+    // list, secondary column headers are left on their own.
+    uint32 primary = primary_cols(matrix);
+    for (uint32 i = 0; i <= cols; i++) {
+        if (i <= primary) {
+            m.llink[i] = i == 0 ? primary : i - 1;
+            m.rlink[i] = i == primary ? 0 : i + 1;
+        } else {
+            m.llink[i] = i;
+            m.rlink[i] = i;
+        }
+        m.ulink[i] = i;
+        m.dlink[i] = i;
+        m.top[i] = 0;
+    }
+
+    uint32 spacer = cols + 1;
+    m.top[spacer] = 0;
+    m.ulink[spacer] = spacer;
+
+    for (size_t row = 0; row < matrix.rows(); row++) {
+        if (m.offsets[row] == m.offsets[row + 1]) {
+            continue;
+        }
+
+        uint32 node = spacer;
+        m.top[spacer] = -int32(row);
+
+        for (size_t i = m.offsets[row]; i < m.offsets[row + 1]; i++) {
+            uint32 header = m.columns[i] + 1;
+            uint32 up = m.ulink[header];
+
+            node++;
+            m.top[node] = header;
+            m.ulink[node] = up;
+            m.dlink[node] = header;
+            m.dlink[up] = node;
+            m.ulink[header] = node;
+            m.top[header]++;
+        }
+
+        // Close the row with a new spacer.
+        m.dlink[spacer] = node;
+        m.ulink[node + 1] = spacer + 1;
+        m.top[node + 1] = 0;
+        spacer = node + 1;
+    }
+
+    m.dlink[spacer] = spacer;
+}
+
+// Choose the next column to cover, i.e. the leftmost column
+// with the least elements. Returns the root if none is left.
+inline uint32 choose_next_column(const CompactCoverMatrix& m) {
+    int32 lower = std::numeric_limits<int32>::max();
+    uint32 next = 0;
+
+    for (uint32 current = m.rlink[0]; current != 0; current = m.rlink[current]) {
+        if (m.top[current] < lower) {
+            lower = m.top[current];
+            next = current;
+        }
+    }
+
+    return next;
+}
+
+// Given an header index, cover the associated column.
+inline void cover_column(CompactCoverMatrix& m, uint32 header) {
+    uint32 left = m.llink[header];
+    uint32 right = m.rlink[header];
+    m.rlink[left] = right;
+    m.llink[right] = left;
+
+    for (uint32 col = m.dlink[header]; col != header; col = m.dlink[col]) {
+        uint32 row = col + 1;
+        while (row != col) {
+            int32 top = m.top[row];
+            if (top <= 0) {
+                row = m.ulink[row];
+            } else {
+                uint32 up = m.ulink[row];
+                uint32 down = m.dlink[row];
+                m.dlink[up] = down;
+                m.ulink[down] = up;
+                m.top[top]--;
+                row++;
+            }
+        }
+    }
+}
+
+// Given an header index, uncover the associated column.
+inline void uncover_column(CompactCoverMatrix& m, uint32 header) {
+    for (uint32 col = m.ulink[header]; col != header; col = m.ulink[col]) {
+        uint32 row = col - 1;
+        while (row != col) {
+            int32 top = m.top[row];
+            if (top <= 0) {
+                row = m.dlink[row];
+            } else {
+                m.dlink[m.ulink[row]] = row;
+                m.ulink[m.dlink[row]] = row;
+                m.top[top]++;
+                row--;
+            }
+        }
+    }
+
+    m.rlink[m.llink[header]] = header;
+    m.llink[m.rlink[header]] = header;
+}
+
+// Retrieve the index of the binary matrix row holding a node.
+inline uint32 row_of(const CompactCoverMatrix& m, uint32 node) {
+    while (m.top[node] > 0) {
+        node--;
+    }
+    return uint32(-m.top[node]);
+}
+
+// The recursive procedure implementing the dancing links algorithm
+// over the compact cover matrix. Indexes of the rows forming the
+// exact cover will be appended to the cover vector if a solution
+// is found.
+inline bool solve(CompactCoverMatrix& m, std::vector<uint32>& cover) {
     bool solved = false;
-    Node* header = choose_next_column(root);
+    uint32 header = choose_next_column(m);
 
-    if (header == root) {
+    if (header == 0) {
         return true;
     }
 
-    cover_column(header);
+    cover_column(m, header);
 
-    Node* column_element = header->down;
-    while (column_element != header) {
-        Node* row_element = column_element->right;
-        while (row_element != column_element) {
-            cover_column(row_element->header);
-            row_element = row_element->right;
+    for (uint32 element = m.dlink[header]; element != header;
+         element = m.dlink[element]) {
+        uint32 row = element + 1;
+        while (row != element) {
+            int32 top = m.top[row];
+            if (top <= 0) {
+                row = m.ulink[row];
+            } else {
+                cover_column(m, top);
+                row++;
+            }
         }
 
-        solved = solve(root, cover);
+        solved = solve(m, cover);
 
-        row_element = column_element->left;
-        while (row_element != column_element) {
-            uncover_column(row_element->header);
-            row_element = row_element->left;
+        row = element - 1;
+        while (row != element) {
+            int32 top = m.top[row];
+            if (top <= 0) {
+                row = m.dlink[row];
+            } else {
+                uncover_column(m, top);
+                row--;
+            }
         }
 
-        // If we've solved the exact cover problem,
-        // set the cell value accordingly.
         if (solved) {
-            cover.push_back(column_element->data);
+            cover.push_back(row_of(m, element));
             break;
         }
+    }
+
+    uncover_column(m, header);
+    return solved;
+}
+
+// Bit-parallel primitives over arrays of 64-bit words, used by the
+// bitset engine. They are vectorized with AVX2 or SSE2 when the
+// compiler targets them, and fall back to plain word operations.
+
+// dst = a & ~b
+inline void andnot_words(uint64* dst, const uint64* a, const uint64* b, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_andnot_si256(vb, va));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_andnot_si128(vb, va));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = a[i] & ~b[i];
+    }
+}
+
+// dst = a & b
+inline void and_words(uint64* dst, const uint64* a, const uint64* b, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(va, vb));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(va, vb));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = a[i] & b[i];
+    }
+}
 
-        column_element = column_element->down;
+inline uint32 lowest_bit(uint64 word) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    uint32 bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        bit++;
     }
+    return bit;
+#endif
+}
+
+// Find the range of words holding the nonzero bits of a mask,
+// storing its first and past the last word indexes in span.
+inline void span(const uint64* words, size_t n, uint32* span) {
+    size_t first = 0;
+    size_t last = n;
+    while (first < n && words[first] == 0) {
+        first++;
+    }
+    while (last > first && words[last - 1] == 0) {
+        last--;
+    }
+    span[0] = uint32(first);
+    span[1] = uint32(last);
+}
+
+// A dense cover matrix for the bit-parallel engine. Each row is a
+// bitmask of its columns, each column a bitmask of its rows, and
+// each row also has the bitmask of the rows it conflicts with, i.e.
+// which share one of its columns. The search state of a level is
+// the set of rows still compatible with the partial cover and the
+// set of primary columns left to cover, so choosing a row costs a
+// couple of ANDNOT over those masks. Column sizes are counters
+// updated from the rows each choice removes. Storage grows
+// quadratically with the number of rows: this engine is meant for
+// small instances with at most a few hundred columns.
+struct BitsetCoverMatrix {
+    size_t row_words;               // Words in a bitmask of rows.
+    size_t col_words;               // Words in a bitmask of columns.
+    std::vector<uint64> columns_of; // Columns of each row.
+    std::vector<uint64> rows_of;    // Rows of each column.
+    std::vector<uint64> conflicts;  // Rows conflicting with each row.
+    std::vector<uint32> column_spans; // Nonzero words of each rows_of mask.
+    std::vector<uint32> row_spans;  // Nonzero words of each conflicts mask.
+    std::vector<uint32> sizes;      // Compatible rows of each column.
+    std::vector<uint64> active;     // Compatible rows at each level.
+    std::vector<uint64> uncovered;  // Primary columns left at each level.
+    std::vector<uint64> candidates; // Rows left to try at each level.
+    std::vector<uint32> chosen;     // Row chosen at each level.
+    std::vector<uint32> columns;    // Nonzero columns, row by row.
+    std::vector<uint32> offsets;    // Start of each row in columns.
+};
+
+// Initialize the bitset cover matrix for a given binary matrix.
+// Storage of the bitset matrix is reused if it's large enough.
+template <typename Matrix>
+void build_cover_matrix(const Matrix& matrix, BitsetCoverMatrix& m) {
+    collect_nonzeros(matrix, m.columns, m.offsets);
+
+    size_t rows = matrix.rows();
+    size_t cols = matrix.cols();
+    size_t primary = primary_cols(matrix);
+    m.row_words = (rows + 63) / 64;
+    m.col_words = (cols + 63) / 64;
+
+    m.columns_of.assign(rows * m.col_words, 0);
+    m.rows_of.assign(cols * m.row_words, 0);
+    m.conflicts.assign(rows * m.row_words, 0);
+    m.sizes.assign(cols, 0);
+
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t i = m.offsets[row]; i < m.offsets[row + 1]; i++) {
+            uint32 col = m.columns[i];
+            m.columns_of[row * m.col_words + col / 64] |= uint64(1) << (col % 64);
+            m.rows_of[col * m.row_words + row / 64] |= uint64(1) << (row % 64);
+            m.sizes[col]++;
+        }
+    }
+
+    // Record the range of words holding the nonzero bits of each
+    // mask, so operations can skip the words known to be zero.
+    m.column_spans.resize(2 * cols);
+    for (size_t col = 0; col < cols; col++) {
+        span(m.rows_of.data() + col * m.row_words, m.row_words,
+             m.column_spans.data() + 2 * col);
+    }
+
+    // Rows conflicting with a row are the union of its columns.
+    m.row_spans.resize(2 * rows);
+    for (size_t row = 0; row < rows; row++) {
+        uint64* conflicts = m.conflicts.data() + row * m.row_words;
+        uint32* row_span = m.row_spans.data() + 2 * row;
+        row_span[0] = uint32(m.row_words);
+        row_span[1] = 0;
+
+        for (size_t i = m.offsets[row]; i < m.offsets[row + 1]; i++) {
+            const uint64* rows_of = m.rows_of.data() + m.columns[i] * m.row_words;
+            const uint32* column_span = m.column_spans.data() + 2 * m.columns[i];
+            for (size_t w = column_span[0]; w < column_span[1]; w++) {
+                conflicts[w] |= rows_of[w];
+            }
+            row_span[0] = std::min(row_span[0], column_span[0]);
+            row_span[1] = std::max(row_span[1], column_span[1]);
+        }
+
+        row_span[0] = std::min(row_span[0], row_span[1]);
+    }
+
+    // A level is entered for each row of the cover, which never
+    // holds more rows than there are primary columns.
+    // Only the first level needs to be initialized, the
+    // others get written as the search goes down.
+    m.active.resize((primary + 1) * m.row_words);
+    m.uncovered.resize((primary + 1) * m.col_words);
+    m.candidates.resize((primary + 1) * m.row_words);
+    m.chosen.resize(primary + 1);
+    std::fill(m.active.begin(), m.active.begin() + m.row_words, 0);
+    std::fill(m.uncovered.begin(), m.uncovered.begin() + m.col_words, 0);
+
+    for (size_t row = 0; row < rows; row++) {
+        m.active[row / 64] |= uint64(1) << (row % 64);
+    }
+    for (size_t col = 0; col < primary; col++) {
+        m.uncovered[col / 64] |= uint64(1) << (col % 64);
+    }
+}
+
+// Choose the primary column left to cover with the least compatible
+// rows, ties going to the leftmost one, and store those rows in the
+// candidates of the level.
+inline void choose_next_column(BitsetCoverMatrix& m, size_t level) {
+    const uint64* uncovered = m.uncovered.data() + level * m.col_words;
+    uint32 lower = std::numeric_limits<uint32>::max();
+    size_t next = 0;
+
+    for (size_t w = 0; w < m.col_words && lower > 0; w++) {
+        for (uint64 bits = uncovered[w]; bits != 0; bits &= bits - 1) {
+            size_t col = w * 64 + lowest_bit(bits);
+            if (m.sizes[col] < lower) {
+                lower = m.sizes[col];
+                next = col;
+            }
+        }
+    }
+
+    const uint64* active = m.active.data() + level * m.row_words;
+    uint64* candidates = m.candidates.data() + level * m.row_words;
+    const uint32* span = m.column_spans.data() + 2 * next;
+    std::fill(candidates, candidates + m.row_words, 0);
+    and_words(candidates + span[0], active + span[0],
+              m.rows_of.data() + next * m.row_words + span[0], span[1] - span[0]);
+}
+
+// Take the first row left to try at a given level out of its
+// candidates. Returns false if there are none left.
+inline bool next_candidate(BitsetCoverMatrix& m, size_t level, uint32& row) {
+    uint64* candidates = m.candidates.data() + level * m.row_words;
+    for (size_t w = 0; w < m.row_words; w++) {
+        if (candidates[w] != 0) {
+            row = uint32(w * 64 + lowest_bit(candidates[w]));
+            candidates[w] &= candidates[w] - 1;
+            return true;
+        }
+    }
+    return false;
+}
 
-    uncover_column(header);
+// Whether no primary column is left to cover at a given level.
+inline bool covered(const BitsetCoverMatrix& m, size_t level) {
+    const uint64* uncovered = m.uncovered.data() + level * m.col_words;
+    for (size_t w = 0; w < m.col_words; w++) {
+        if (uncovered[w] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Adjust the column sizes by delta for every compatible row
+// at a given level which conflicts with the given row.
+inline void resize_columns(BitsetCoverMatrix& m, size_t level, uint32 row, uint32 delta) {
+    const uint64* active = m.active.data() + level * m.row_words;
+    const uint64* conflicts = m.conflicts.data() + row * m.row_words;
+    const uint32* span = m.row_spans.data() + 2 * row;
+
+    for (size_t w = span[0]; w < span[1]; w++) {
+        for (uint64 bits = active[w] & conflicts[w]; bits != 0; bits &= bits - 1) {
+            size_t removed = w * 64 + lowest_bit(bits);
+            for (size_t i = m.offsets[removed]; i < m.offsets[removed + 1]; i++) {
+                m.sizes[m.columns[i]] += delta;
+            }
+        }
+    }
+}
+
+// Add a row to the cover, going from a given level to the next.
+inline void choose_row(BitsetCoverMatrix& m, size_t level, uint32 row) {
+    const uint64* active = m.active.data() + level * m.row_words;
+    uint64* next_active = m.active.data() + (level + 1) * m.row_words;
+    const uint32* span = m.row_spans.data() + 2 * row;
+
+    // Rows outside of the conflicts span stay as they were.
+    std::copy(active, active + span[0], next_active);
+    andnot_words(next_active + span[0], active + span[0],
+                 m.conflicts.data() + row * m.row_words + span[0], span[1] - span[0]);
+    std::copy(active + span[1], active + m.row_words, next_active + span[1]);
+
+    andnot_words(m.uncovered.data() + (level + 1) * m.col_words,
+                 m.uncovered.data() + level * m.col_words,
+                 m.columns_of.data() + row * m.col_words, m.col_words);
+
+    resize_columns(m, level, row, uint32(-1));
+    m.chosen[level] = row;
+}
+
+// Algorithm X over the bitset cover matrix, with an explicit stack
+// of levels. Indexes of the rows forming the exact cover are appended
+// to the cover vector if a solution is found.
+inline bool solve(BitsetCoverMatrix& m, std::vector<uint32>& cover) {
+    size_t level = 0;
+    bool descend = true;
+
+    while (true) {
+        if (descend) {
+            if (covered(m, level)) {
+                cover.insert(cover.end(), m.chosen.begin(), m.chosen.begin() + level);
+                return true;
+            }
+            choose_next_column(m, level);
+        }
+
+        uint32 row;
+        if (!next_candidate(m, level, row)) {
+            if (level == 0) {
+                return false;
+            }
+
+            // Backtrack, restoring the column sizes.
+            level--;
+            resize_columns(m, level, m.chosen[level], 1);
+            descend = false;
+            continue;
+        }
+
+        choose_row(m, level, row);
+        level++;
+        descend = true;
+    }
+}
+
+// Forwards the nonzero iteration of sparse matrices.
+template <typename Matrix, bool Sparse = is_sparse<Matrix>::value>
+class SparseForwarder {
+public:
+    SparseForwarder(const Matrix& matrix) : matrix(matrix) {}
+
+protected:
+    const Matrix& matrix;
+};
+
+template <typename Matrix>
+class SparseForwarder<Matrix, true> {
+public:
+    typedef typename Matrix::nonzero_iterator nonzero_iterator;
+
+    SparseForwarder(const Matrix& matrix) : matrix(matrix) {}
+
+    nonzero_iterator nonzero_begin(uint32 row) const {
+        return matrix.nonzero_begin(row);
+    }
+
+    nonzero_iterator nonzero_end(uint32 row) const {
+        return matrix.nonzero_end(row);
+    }
+
+protected:
+    const Matrix& matrix;
+};
+
+} // namespace details
+
+// Presents a binary matrix as a generalized exact cover instance,
+// whose first primary columns must be covered exactly once while the
+// remaining secondary ones may be covered at most once. Secondary
+// columns are never chosen by the search, but still get covered
+// along with the rows using them. The matrix must outlive the view.
+template <typename Matrix>
+class PrimaryColumns : public details::SparseForwarder<Matrix> {
+public:
+    PrimaryColumns(const Matrix& matrix, uint32 primary) :
+        details::SparseForwarder<Matrix>(matrix), primary(primary) {}
+
+    bool operator()(uint32 row, uint32 col) const {
+        return this->matrix(row, col) != 0;
+    }
+
+    uint32 rows() const { return this->matrix.rows(); }
+    uint32 cols() const { return this->matrix.cols(); }
+    uint32 primary_cols() const { return primary; }
+
+private:
+    uint32 primary;
+};
+
+// Convenience wrapper declaring the number of primary
+// columns of a matrix, see PrimaryColumns.
+template <typename Matrix>
+PrimaryColumns<Matrix> primary_columns(const Matrix& matrix, uint32 primary) {
+    return PrimaryColumns<Matrix>(matrix, primary);
+}
+
+// Storage reused across calls to solve(). Its content is an
+// implementation detail, it only has to outlive the solve calls.
+typedef details::NodeArena Arena;
+
+// Choose the column with the least elements, ties going to the
+// leftmost one. This is the minimum remaining values rule.
+struct MinimumRemainingValues : ColumnPolicy {
+    details::Node* choose(details::Node* root) {
+        return details::choose_next_column(root);
+    }
+};
+
+// Choose the leftmost column, whatever its size.
+struct FirstColumn : ColumnPolicy {
+    details::Node* choose(details::Node* root) {
+        return root->right;
+    }
+};
+
+// Choose a column with the least elements, ties being
+// broken uniformly at random from the given seed.
+class RandomizedMinimumRemainingValues : public ColumnPolicy {
+public:
+    explicit RandomizedMinimumRemainingValues(uint64 seed = 1) :
+        state(seed != 0 ? seed : 1) {}
+
+    details::Node* choose(details::Node* root) {
+        uint32 lower = std::numeric_limits<uint32>::max();
+        uint32 ties = 0;
+        details::Node* next = root->right;
+
+        for (details::Node* current = root->right; current != root;
+             current = current->right) {
+            if (current->data < lower) {
+                lower = current->data;
+                next = current;
+                ties = 1;
+            } else if (current->data == lower && random() % ++ties == 0) {
+                next = current;
+            }
+        }
+
+        return next;
+    }
+
+private:
+    // Xorshift generator, good enough to break ties.
+    uint64 random() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    uint64 state;
+};
+
+// Choose the column minimizing its number of elements divided by
+// its priority, so that high priority columns get chosen earlier.
+// Priorities are given per column of the binary matrix, and must
+// all be positive. Ties go to the leftmost column.
+class WeightedMinimumRemainingValues : public ColumnPolicy {
+public:
+    explicit WeightedMinimumRemainingValues(const std::vector<uint32>& priorities) :
+        priorities(&priorities) {}
+
+    details::Node* choose(details::Node* root) {
+        details::Node* next = root->right;
+        uint64 size = next->data;
+        uint64 priority = priority_of(root, next);
+
+        for (details::Node* current = next->right; current != root;
+             current = current->right) {
+            uint64 current_priority = priority_of(root, current);
+            if (current->data * priority < size * current_priority) {
+                next = current;
+                size = current->data;
+                priority = current_priority;
+            }
+        }
+
+        return next;
+    }
+
+private:
+    // Column headers immediately follow the root in the arena.
+    uint64 priority_of(details::Node* root, details::Node* header) const {
+        return (*priorities)[header - root - 1];
+    }
+
+    const std::vector<uint32>* priorities;
+};
+
+// Choose a column with the least elements, like
+// MinimumRemainingValues, but without scanning every column. Columns
+// are kept in circular lists indexed by their size, which covering
+// and uncovering update incrementally, so the smallest column is
+// found in near constant time. Ties go to the column most recently
+// moved to the smallest size. Worth it when there are many columns.
+class BucketedMinimumRemainingValues : public ColumnPolicy {
+public:
+    BucketedMinimumRemainingValues() : root(0), cols(0), lowest(0) {}
+
+    void initialize(details::Node* root) {
+        uint32 largest = 0;
+        this->root = root;
+        cols = 0;
+        for (details::Node* header = root->right; header != root;
+             header = header->right) {
+            cols = std::max(cols, index(header) + 1);
+            largest = std::max(largest, header->data);
+        }
+
+        // Entries past the columns are the heads of the buckets.
+        next.resize(cols + largest + 1);
+        prev.resize(cols + largest + 1);
+        for (uint32 size = 0; size <= largest; size++) {
+            next[cols + size] = cols + size;
+            prev[cols + size] = cols + size;
+        }
+
+        // Append columns from the right, so the leftmost
+        // ones come first in their bucket.
+        for (details::Node* header = root->left; header != root;
+             header = header->left) {
+            link(index(header), header->data);
+        }
+        lowest = 0;
+    }
+
+    details::Node* choose(details::Node*) {
+        while (next[cols + lowest] == cols + lowest) {
+            lowest++;
+        }
+        return root + 1 + next[cols + lowest];
+    }
+
+    void hide(details::Node* header) {
+        if (index(header) < cols) {
+            unlink(index(header));
+        }
+    }
+
+    void unhide(details::Node* header) {
+        if (index(header) < cols) {
+            link(index(header), header->data);
+        }
+    }
+
+    void decrement(details::Node* header) {
+        move(index(header), header->data);
+    }
+
+    void increment(details::Node* header) {
+        move(index(header), header->data);
+    }
+
+private:
+    // Column headers immediately follow the root in the arena.
+    uint32 index(details::Node* header) const {
+        return header - root - 1;
+    }
+
+    // Insert a column at the front of the bucket of a given size.
+    void link(uint32 col, uint32 size) {
+        uint32 head = cols + size;
+        next[col] = next[head];
+        prev[col] = head;
+        prev[next[head]] = col;
+        next[head] = col;
+        lowest = std::min(lowest, size);
+    }
+
+    void unlink(uint32 col) {
+        next[prev[col]] = next[col];
+        prev[next[col]] = prev[col];
+    }
+
+    // Move a column to the bucket of its new size. Secondary columns,
+    // which follow the primary ones, aren't kept in the buckets.
+    void move(uint32 col, uint32 size) {
+        if (col < cols) {
+            unlink(col);
+            link(col, size);
+        }
+    }
+
+    details::Node* root;
+    uint32 cols;                // Number of primary columns.
+    uint32 lowest;              // No bucket below this one is occupied.
+    std::vector<uint32> next;   // Bucket links of columns and heads.
+    std::vector<uint32> prev;
+};
+
+// A resumable dancing links search, producing the exact covers of an
+// instance one at a time. The search is iterative: the element tried
+// at each level is kept on an explicit stack preallocated in the
+// arena, so its depth isn't bounded by the thread stack and it can be
+// suspended after any solution and resumed later on. Only one search
+// may use a given arena at a time. Columns to cover are chosen by
+// the Policy, see MinimumRemainingValues.
+//
+// The cover matrix is built once, so a search can be restarted any
+// number of times with some rows forced into every cover, e.g. the
+// givens of a puzzle. Forcing a row only covers its columns, which
+// makes repeated queries on one matrix much cheaper than rebuilding
+// a reduced matrix for each of them.
+//
+// The work done is recorded in the Stats, see SearchStats. By default
+// nothing is recorded and the search runs at full speed. Likewise, a
+// search whose Record flag is false, such as count() uses, doesn't
+// store the rows it chooses and has no cover to show.
+template <typename Policy, typename Stats = NullStats, bool Record = true>
+class BasicSearch {
+public:
+    template <typename Matrix>
+    explicit BasicSearch(const Matrix& matrix, const Policy& policy = Policy()) :
+        arena(storage), policy(policy) {
+        initialize(matrix);
+    }
+
+    template <typename Matrix>
+    BasicSearch(const Matrix& matrix, Arena& arena, const Policy& policy = Policy()) :
+        arena(arena), policy(policy) {
+        initialize(matrix);
+    }
+
+    // Advance to the next exact cover. Returns false once every
+    // cover has been produced, in which case the cover matrix is
+    // restored to its state following the last restart() and the
+    // search starts over on the following call. Also returns false,
+    // with the cover matrix restored likewise, once the budget has
+    // run out, see exhausted().
+    bool next() {
+        if (!feasible) {
+            return false;
+        }
+
+        // Resume after the previous solution by leaving its level.
+        bool descend = !started;
+        started = true;
+
+        while (true) {
+            if (descend) {
+                // Enter a new level: either every column has been
+                // covered and a solution is found, or choose the
+                // next column to cover and try its first element.
+                policy.stats.enter(level);
+                if (!budget.charge()) {
+                    unwind(base);
+                    started = false;
+                    return false;
+                }
+
+                if (root->right == root) {
+                    return true;
+                }
+
+                details::Node* header = policy.choose(root);
+                details::cover_column(header, policy);
+                arena.choices[level] = header->down;
+            } else {
+                // Leave the current level and try the next
+                // element of the column chosen at the previous one.
+                if (level == base) {
+                    started = false;
+                    return false;
+                }
+
+                level--;
+                details::uncover_row(arena.choices[level], policy);
+                arena.choices[level] = arena.choices[level]->down;
+            }
+
+            details::Node* element = arena.choices[level];
+            if (element == element->header) {
+                // Every element of the column has been tried.
+                details::uncover_column(element, policy);
+                descend = false;
+            } else {
+                details::cover_row(element, policy);
+                if (Record) {
+                    arena.partial[level] = element->data;
+                }
+                level++;
+                descend = true;
+            }
+        }
+    }
+
+    // Rows of the current exact cover, forced ones first, valid
+    // until next() or restart() is called.
+    CoverView cover() const {
+        static_assert(Record, "A search which doesn't record its rows has no cover.");
+        const uint32* rows = level == 0 ? 0 : &arena.partial[0];
+        return CoverView(rows, rows + level);
+    }
+
+    // Limit the work of the search from now on, see Budget.
+    void limit(const Budget& budget) {
+        this->budget = budget;
+    }
+
+    // Whether the search was stopped for lack of budget.
+    bool exhausted() const {
+        return budget.exhausted();
+    }
+
+    // Work done by the search since its construction.
+    const Stats& stats() const {
+        return policy.stats;
+    }
+
+    // Abandon the current search, restore the cover matrix and start
+    // over with the given rows forced into every cover. Returns false
+    // if two forced rows share a column or one isn't a row of the
+    // matrix, in which case next() finds no cover until the search
+    // is restarted with other rows.
+    bool restart(const std::vector<uint32>& forced = std::vector<uint32>()) {
+        // Undo the rows chosen by the search, then the forced ones.
+        unwind(0);
+        started = false;
+        feasible = true;
+        arena.covered.assign(cols, false);
+        size_t depth = cols + 1 + forced.size();
+        if (arena.partial.size() < depth) {
+            arena.partial.resize(depth);
+            arena.choices.resize(depth);
+        }
+
+        for (size_t i = 0; i < forced.size(); i++) {
+            uint32 row = forced[i];
+            if (row >= arena.offsets.size() - 1) {
+                feasible = false;
+                break;
+            }
+            uint32 first = arena.offsets[row];
+            uint32 last = arena.offsets[row + 1];
+
+            // Reject rows overlapping the previous ones.
+            for (uint32 j = first; j < last; j++) {
+                if (arena.covered[arena.columns[j]]) {
+                    feasible = false;
+                    break;
+                }
+                arena.covered[arena.columns[j]] = true;
+            }
+
+            if (!feasible) {
+                // Forced rows covered so far are undone next time.
+                break;
+            }
+
+            // Nodes follow the root and column headers in the arena,
+            // row by row. Empty rows are forced without covering.
+            details::Node* element = 0;
+            if (first != last) {
+                element = root + 1 + cols + first;
+                details::cover_column(element->header, policy);
+                details::cover_row(element, policy);
+            }
+
+            arena.choices[level] = element;
+            arena.partial[level] = row;
+            level++;
+        }
+
+        base = level;
+        return feasible;
+    }
+
+private:
+    BasicSearch(const BasicSearch&);
+    BasicSearch& operator=(const BasicSearch&);
+
+    // Uncover the rows of the levels above depth, and their columns.
+    void unwind(size_t depth) {
+        while (level > depth) {
+            level--;
+            details::Node* element = arena.choices[level];
+            if (element != 0) {
+                details::uncover_row(element, policy);
+                details::uncover_column(element->header, policy);
+            }
+        }
+    }
+
+    template <typename Matrix>
+    void initialize(const Matrix& matrix) {
+        root = details::build_cover_matrix(matrix, arena);
+        policy.initialize(root);
+        cols = matrix.cols();
+        level = 0;
+        base = 0;
+        started = false;
+        feasible = true;
+
+        // A cover never holds more rows than there are primary
+        // columns, and a level is entered for each row of the cover.
+        arena.partial.resize(matrix.cols() + 1);
+        arena.choices.resize(matrix.cols() + 1);
+    }
+
+    typedef details::Instrumented<Policy, Stats> Hooks;
+
+    Arena storage;              // Storage used when no arena is given.
+    Arena& arena;               // Storage of the cover matrix and stacks.
+    Hooks policy;               // Column selection heuristic and statistics.
+    Budget budget;              // Limits on the work of the search.
+    details::Node* root;        // Root of the cover matrix.
+    size_t level;               // Current depth of the search.
+    size_t base;                // Number of forced rows.
+    bool started;               // Whether a solution is being visited.
+    bool feasible;              // Whether the forced rows are compatible.
+    size_t cols;                // Number of columns of the cover matrix.
+};
+
+typedef BasicSearch<MinimumRemainingValues> Search;
+
+// Solve an exact cover instance encoded into a binary matrix using
+// the given arena to hold the cover matrix. Indexes of the rows
+// forming the exact cover are stored in the cover vector, which is
+// emptied beforehand. Returns whether a solution was found.
+template <typename Matrix, typename Policy = MinimumRemainingValues>
+bool solve(const Matrix& matrix, Arena& arena, std::vector<uint32>& cover,
+           const Policy& policy = Policy()) {
+    NullStats stats;
+    return solve(matrix, arena, cover, policy, stats);
+}
+
+// Solve an exact cover instance as above, also recording the
+// work done by the search in the given stats, see SearchStats.
+template <typename Matrix, typename Policy, typename Stats>
+bool solve(const Matrix& matrix, Arena& arena, std::vector<uint32>& cover,
+           const Policy& policy, Stats& stats) {
+    BasicSearch<Policy, Stats> search(matrix, arena, policy);
+    bool solved = search.next();
+    cover.assign(search.cover().begin(), search.cover().end());
+    stats = search.stats();
     return solved;
 }
 
-// Allocate and initialize the cover matrix for a given binary
-// matrix. The cover matrix should be deallocated with the
-// delete_cover_matrix(Node*) function.
+// Solve an exact cover instance as above, within the given budget.
+// Tells whether a cover was found, none exists, or the budget ran
+// out first, in which case the cover is left empty.
+template <typename Matrix, typename Policy = MinimumRemainingValues>
+Status solve_within(const Matrix& matrix, Arena& arena, std::vector<uint32>& cover,
+                    const Budget& budget, const Policy& policy = Policy()) {
+    BasicSearch<Policy> search(matrix, arena, policy);
+    search.limit(budget);
+    bool solved = search.next();
+    cover.assign(search.cover().begin(), search.cover().end());
+    if (solved) {
+        return SOLVED;
+    }
+    return search.exhausted() ? EXHAUSTED : UNSOLVABLE;
+}
+
+// Enumerate every exact cover of an instance encoded into a binary
+// matrix, using the given arena to hold the cover matrix. For each
+// solution, the visitor is called with a CoverView over its rows
+// and returns true to continue the enumeration or false to stop it.
+// Returns false if the enumeration was stopped by the visitor.
+template <typename Matrix, typename Visitor,
+          typename Policy = MinimumRemainingValues>
+bool enumerate(const Matrix& matrix, Arena& arena, Visitor visitor,
+               const Policy& policy = Policy()) {
+    BasicSearch<Policy> search(matrix, arena, policy);
+    while (search.next()) {
+        if (!visitor(search.cover())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Enumerate every exact cover of an instance, see above.
+template <typename Matrix, typename Visitor>
+bool enumerate(const Matrix& matrix, Visitor visitor) {
+    Arena arena;
+    return enumerate(matrix, arena, visitor);
+}
+
+// Count the exact covers of an instance encoded into a binary
+// matrix, using the given arena to hold the cover matrix. Counting
+// stops once limit covers have been found, e.g. a limit of 2 is
+// enough to tell whether an instance has a unique solution.
+template <typename Matrix, typename Policy = MinimumRemainingValues>
+uint64 count(const Matrix& matrix, Arena& arena,
+             uint64 limit = std::numeric_limits<uint64>::max(),
+             const Policy& policy = Policy()) {
+    NullStats stats;
+    return count(matrix, arena, limit, policy, stats);
+}
+
+// Count the exact covers of an instance as above, also recording
+// the work done by the search in the given stats, see SearchStats.
+template <typename Matrix, typename Policy, typename Stats>
+uint64 count(const Matrix& matrix, Arena& arena, uint64 limit,
+             const Policy& policy, Stats& stats) {
+    uint64 total = 0;
+    BasicSearch<Policy, Stats, false> search(matrix, arena, policy);
+    while (total < limit && search.next()) {
+        total++;
+    }
+    stats = search.stats();
+    return total;
+}
+
+// Count the exact covers of an instance, see above.
 template <typename Matrix>
-Node* build_cover_matrix(const Matrix& matrix)  {
-    Node* root = build_root();
+uint64 count(const Matrix& matrix,
+             uint64 limit = std::numeric_limits<uint64>::max()) {
+    Arena arena;
+    return count(matrix, arena, limit);
+}
 
-    // These vectors will be used to get fast access to row and
-    // column headers during the initialization phase of the cover
-    // matrix. Row headers will immediately be deleted at the
-    // end of the initialization process.
-    std::vector<Node*> row_headers = build_row_headers(root, matrix.rows());
-    std::vector<Node*> column_headers = build_column_headers(root, matrix.cols());
+// A zero-suppressed decision diagram (ZDD) of a family of exact
+// covers. Nodes 0 and 1 are the terminals, standing for no cover at
+// all and for the empty cover. Any other node holds a row, and stands
+// for the covers of its hi node, to which the row is added, along
+// with the covers of its lo node. Children always precede their
+// parents, so the diagram is evaluated bottom up in a single pass.
+class ZDD {
+public:
+    struct Node {
+        uint32 row;
+        uint32 lo;
+        uint32 hi;
+    };
 
-    for (size_t row = 0; row < matrix.rows(); row++) {
-        Node* row_first = row_headers[row];
-        Node* row_last = row_headers[row];
-
-        for (size_t col = 0; col < matrix.cols(); col++) {
-            if (matrix(row, col)) {
-                Node* header = column_headers[col];
-
-                // Initialize new node.
-                Node* node = new Node;
-                node->header = header;
-                node->up = header->up;
-                node->down = header;
-                node->left = row_last;
-                node->right = row_first;
-                node->data = row;
+    ZDD() {
+        clear();
+    }
 
-                // Update neighbors.
-                node->up->down = node;
-                node->left->right = node;
+    // Forget every node but the terminals.
+    void clear() {
+        nodes.resize(2);
+        nodes[0].row = nodes[1].row = std::numeric_limits<uint32>::max();
+        nodes[0].lo = nodes[0].hi = 0;
+        nodes[1].lo = nodes[1].hi = 1;
+        top = 0;
+        counts.clear();
+    }
 
-                header->up = node;
-                header->data++;
+    // Append a node, returning its index.
+    uint32 add(uint32 row, uint32 lo, uint32 hi) {
+        Node node = { row, lo, hi };
+        nodes.push_back(node);
+        counts.clear();
+        return nodes.size() - 1;
+    }
 
-                row_first->left = node;
-                row_last = node;
+    uint32 root() const { return top; }
+    void root(uint32 node) { top = node; }
+
+    size_t size() const { return nodes.size(); }
+    const Node& operator[](uint32 node) const { return nodes[node]; }
+
+    // Number of covers in the family, which mustn't overflow.
+    uint64 count() const {
+        if (counts.empty()) {
+            counts.resize(nodes.size());
+            counts[0] = 0;
+            counts[1] = 1;
+            for (size_t i = 2; i < nodes.size(); i++) {
+                counts[i] = counts[nodes[i].lo] + counts[nodes[i].hi];
             }
         }
+        return counts[top];
     }
 
-    delete_row_headers(row_headers);
+    // Retrieve the rows of the cover of a given rank, between 0 and
+    // count() exclusively. Covers holding the row of a node rank
+    // before those of its lo node. Returns false for a bad rank.
+    bool cover(uint64 rank, std::vector<uint32>& rows) const {
+        rows.clear();
+        if (rank >= count()) {
+            return false;
+        }
 
-    return root;
+        for (uint32 node = top; node > 1;) {
+            if (rank < counts[nodes[node].hi]) {
+                rows.push_back(nodes[node].row);
+                node = nodes[node].hi;
+            } else {
+                rank -= counts[nodes[node].hi];
+                node = nodes[node].lo;
+            }
+        }
+        return true;
+    }
+
+    // Draw a cover uniformly at random, using a random number
+    // generator such as std::mt19937_64. Returns false if the
+    // family holds no cover.
+    template <typename Generator>
+    bool sample(Generator& generator, std::vector<uint32>& rows) const {
+        if (count() == 0) {
+            rows.clear();
+            return false;
+        }
+        std::uniform_int_distribution<uint64> rank(0, count() - 1);
+        return cover(rank(generator), rows);
+    }
+
+private:
+    std::vector<Node> nodes;
+    uint32 top;                             // Node standing for the family.
+    mutable std::vector<uint64> counts;     // Covers of each node, if known.
+};
+
+namespace details {
+
+// A column policy also keeping track of the columns left in the
+// cover matrix, primary or secondary, one bit per column. Since the
+// rows left are those whose columns are all left, the columns tell
+// a residual subproblem apart, whatever the rows leading to it.
+template <typename Policy>
+struct Signed {
+    explicit Signed(const Policy& policy) : policy(policy), root(0) {}
+
+    Node* choose(Node* root) {
+        return policy.choose(root);
+    }
+
+    void initialize(Node* root, uint32 cols) {
+        this->root = root;
+        signature.assign((cols + 63) / 64, 0);
+        for (uint32 col = 0; col < cols; col++) {
+            signature[col / 64] |= uint64(1) << (col % 64);
+        }
+        policy.initialize(root);
+    }
+
+    // Column headers immediately follow the root in the arena.
+    void hide(Node* header) {
+        uint32 col = header - root - 1;
+        signature[col / 64] &= ~(uint64(1) << (col % 64));
+        policy.hide(header);
+    }
+
+    void unhide(Node* header) {
+        uint32 col = header - root - 1;
+        signature[col / 64] |= uint64(1) << (col % 64);
+        policy.unhide(header);
+    }
+
+    void decrement(Node* header) {
+        policy.decrement(header);
+    }
+
+    void increment(Node* header) {
+        policy.increment(header);
+    }
+
+    Policy policy;
+    Node* root;
+    std::vector<uint64> signature;  // Columns left in the cover matrix.
+};
+
+// FNV-1a over the words of a signature.
+struct SignatureHash {
+    size_t operator()(const std::vector<uint64>& signature) const {
+        uint64 hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < signature.size(); i++) {
+            hash = (hash ^ signature[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+// Diagrams of the residual subproblems solved so far.
+typedef std::unordered_map<std::vector<uint64>, uint32, SignatureHash> Memo;
+
+// The recursive procedure of Knuth's DXZ, i.e. dancing links with
+// memoization. Builds the diagram of the covers of the subproblem
+// left in the cover matrix and returns its node. A subproblem met
+// again through other rows gets the node built the first time.
+template <typename Policy>
+uint32 build_diagram(Node* root, Signed<Policy>& policy, Memo& memo, ZDD& zdd) {
+    if (root->right == root) {
+        return 1;
+    }
+
+    Memo::const_iterator known = memo.find(policy.signature);
+    if (known != memo.end()) {
+        return known->second;
+    }
+    std::vector<uint64> signature(policy.signature);
+
+    // Rows are tried from the bottom up, so that in the diagram
+    // they come in the order of the column.
+    Node* header = policy.choose(root);
+    cover_column(header, policy);
+
+    uint32 family = 0;
+    for (Node* element = header->up; element != header; element = element->up) {
+        cover_row(element, policy);
+        uint32 covers = build_diagram(root, policy, memo, zdd);
+        uncover_row(element, policy);
+
+        if (covers != 0) {
+            family = zdd.add(element->data, family, covers);
+        }
+    }
+
+    uncover_column(header, policy);
+    memo.insert(std::make_pair(signature, family));
+    return family;
 }
 
 } // namespace details
 
+// Build the decision diagram of every exact cover of an instance
+// encoded into a binary matrix, using the given arena to hold the
+// cover matrix. Residual subproblems reached through different rows
+// are only solved once, which can make counting the covers of some
+// instances, such as tilings, faster by orders of magnitude. Their
+// solutions are kept in memory meanwhile, which can get large.
+template <typename Matrix, typename Policy>
+void decision_diagram(const Matrix& matrix, Arena& arena, ZDD& zdd,
+                      const Policy& policy) {
+    details::Node* root = details::build_cover_matrix(matrix, arena);
+    details::Signed<Policy> hooks(policy);
+    hooks.initialize(root, matrix.cols());
+    details::Memo memo;
+
+    zdd.clear();
+    zdd.root(details::build_diagram(root, hooks, memo, zdd));
+}
+
+// Build the decision diagram of every exact cover of an instance,
+// see above.
+template <typename Matrix>
+ZDD decision_diagram(const Matrix& matrix) {
+    Arena arena;
+    ZDD zdd;
+    decision_diagram(matrix, arena, zdd, MinimumRemainingValues());
+    return zdd;
+}
+
+// Storage for the compact cover matrix, see Arena. Solving with a
+// compact arena selects the index based dancing links engine, which
+// is better suited to very large instances.
+typedef details::CompactCoverMatrix CompactArena;
+
+// Solve an exact cover instance using the compact engine.
+template <typename Matrix>
+bool solve(const Matrix& matrix, CompactArena& arena, std::vector<uint32>& cover) {
+    cover.clear();
+    details::build_cover_matrix(matrix, arena);
+    return details::solve(arena, cover);
+}
+
+// Storage for the bitset cover matrix, see Arena. Solving with a
+// bitset arena selects the bit-parallel engine, which is faster than
+// dancing links on small dense instances, with at most a few hundred
+// columns, but whose storage grows quadratically with the rows.
+typedef details::BitsetCoverMatrix BitsetArena;
+
+// Solve an exact cover instance using the bit-parallel engine.
+template <typename Matrix>
+bool solve(const Matrix& matrix, BitsetArena& arena, std::vector<uint32>& cover) {
+    cover.clear();
+    details::build_cover_matrix(matrix, arena);
+    return details::solve(arena, cover);
+}
+
 // Solve an exact cover instance encoded into a binary matrix.
 // Indexes of the rows forming the exact cover are returned in
 // a vector. If no solution was found, an empty vector is returned.
-template <typename Matrix>
+// The engine is selected by the storage type, i.e. Arena,
+// CompactArena or BitsetArena.
+template <typename Storage, typename Matrix>
 std::vector<uint32> solve(const Matrix& matrix) {
+    Storage storage;
     std::vector<uint32> cover;
-    details::Node* root;
-
-    root = details::build_cover_matrix(matrix);
-    details::solve(root, cover);
-    details::delete_cover_matrix(root);
-
+    solve(matrix, storage, cover);
     return cover;
 }
 
+// Solve an exact cover instance with the default engine.
+template <typename Matrix>
+std::vector<uint32> solve(const Matrix& matrix) {
+    return solve<Arena>(matrix);
+}
+
 } // namespace exact_cover
 
 #endif // EXACT_COVER_SOLVER_HPP_
@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EXACT_COVER_COMPONENTS_HPP_
+#define EXACT_COVER_COMPONENTS_HPP_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "types.hpp"
+#include "exact_cover.hpp"
+
+namespace exact_cover {
+
+namespace details {
+
+// Some rows and columns of a binary matrix, renumbered from zero with
+// the primary columns first, along with the matrix row each of its
+// rows comes from. Blocks are binary matrices themselves.
+struct Block {
+    typedef std::vector<uint32>::const_iterator nonzero_iterator;
+
+    Block() : ncols(0), nprimary(0) {
+        offsets.push_back(0);
+    }
+
+    bool operator()(uint32 row, uint32 col) const {
+        return std::find(nonzero_begin(row), nonzero_end(row), col) != nonzero_end(row);
+    }
+
+    nonzero_iterator nonzero_begin(uint32 row) const {
+        return columns.begin() + offsets[row];
+    }
+
+    nonzero_iterator nonzero_end(uint32 row) const {
+        return columns.begin() + offsets[row + 1];
+    }
+
+    uint32 rows() const { return origin.size(); }
+    uint32 cols() const { return ncols; }
+    uint32 primary_cols() const { return nprimary; }
+
+    std::vector<uint32> columns;    // Nonzero columns, row by row.
+    std::vector<uint32> offsets;    // Start of each row in columns.
+    std::vector<uint32> origin;     // Matrix row of each row.
+    uint32 ncols;                   // Number of columns.
+    uint32 nprimary;                // Number of primary columns.
+};
+
+// Copy a binary matrix into a block holding all of it.
+template <typename Matrix>
+void collect_block(const Matrix& matrix, Block& block) {
+    collect_nonzeros(matrix, block.columns, block.offsets);
+    block.origin.resize(matrix.rows());
+    for (uint32 row = 0; row < matrix.rows(); row++) {
+        block.origin[row] = row;
+    }
+    block.ncols = matrix.cols();
+    block.nprimary = primary_cols(matrix);
+}
+
+// Append a row of a block to another one, renumbering its columns.
+inline void append_row(const Block& from, uint32 row,
+                       const std::vector<uint32>& renumbered, Block& to) {
+    for (uint32 i = from.offsets[row]; i < from.offsets[row + 1]; i++) {
+        to.columns.push_back(renumbered[from.columns[i]]);
+    }
+    to.offsets.push_back(to.columns.size());
+    to.origin.push_back(from.origin[row]);
+}
+
+inline uint32 find_set(std::vector<uint32>& parent, uint32 col) {
+    while (parent[col] != col) {
+        parent[col] = parent[parent[col]];
+        col = parent[col];
+    }
+    return col;
+}
+
+inline bool fewer_rows(const Block& a, const Block& b) {
+    return a.rows() < b.rows();
+}
+
+// Split a block into the connected components of its rows and
+// columns, two columns being connected when a row holds both. A
+// component without primary columns only has the empty cover and
+// is left out, as are empty rows. A primary column without rows is a
+// component of its own, which has no cover. Components come smallest
+// first, so that one without cover tends to be found early on.
+inline void split(const Block& block, std::vector<Block>& components) {
+    std::vector<uint32> parent(block.ncols);
+    for (uint32 col = 0; col < block.ncols; col++) {
+        parent[col] = col;
+    }
+    for (uint32 row = 0; row < block.rows(); row++) {
+        for (uint32 i = block.offsets[row] + 1; i < block.offsets[row + 1]; i++) {
+            uint32 a = find_set(parent, block.columns[block.offsets[row]]);
+            uint32 b = find_set(parent, block.columns[i]);
+            parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    // Number the components holding a primary column, then renumber
+    // columns within their component, in order. Each set is rooted at
+    // its first column, so a set first met at a secondary column has
+    // no primary column.
+    const uint32 none = std::numeric_limits<uint32>::max();
+    std::vector<uint32> component(block.ncols, none);
+    std::vector<uint32> renumbered(block.ncols, 0);
+    components.clear();
+    for (uint32 col = 0; col < block.ncols; col++) {
+        uint32 set = find_set(parent, col);
+        if (component[set] == none) {
+            if (col >= block.nprimary) {
+                continue;
+            }
+            component[set] = components.size();
+            components.push_back(Block());
+        }
+
+        Block& owner = components[component[set]];
+        renumbered[col] = owner.ncols++;
+        owner.nprimary += col < block.nprimary;
+    }
+
+    for (uint32 row = 0; row < block.rows(); row++) {
+        if (block.offsets[row] == block.offsets[row + 1]) {
+            continue;
+        }
+        uint32 set = find_set(parent, block.columns[block.offsets[row]]);
+        if (component[set] != none) {
+            append_row(block, row, renumbered, components[component[set]]);
+        }
+    }
+
+    std::stable_sort(components.begin(), components.end(), fewer_rows);
+}
+
+// Build the block left once a row of a block is put in the cover,
+// i.e. without its columns nor the rows sharing one of them.
+inline void choose_row(const Block& block, uint32 chosen, Block& residual) {
+    const uint32 none = std::numeric_limits<uint32>::max();
+    std::vector<uint32> renumbered(block.ncols, 0);
+    for (uint32 i = block.offsets[chosen]; i < block.offsets[chosen + 1]; i++) {
+        renumbered[block.columns[i]] = none;
+    }
+
+    residual = Block();
+    for (uint32 col = 0; col < block.ncols; col++) {
+        if (renumbered[col] != none) {
+            renumbered[col] = residual.ncols++;
+            residual.nprimary += col < block.nprimary;
+        }
+    }
+
+    for (uint32 row = 0; row < block.rows(); row++) {
+        bool conflict = false;
+        for (uint32 i = block.offsets[row]; i < block.offsets[row + 1] && !conflict; i++) {
+            conflict = renumbered[block.columns[i]] == none;
+        }
+        if (!conflict && row != chosen) {
+            append_row(block, row, renumbered, residual);
+        }
+    }
+}
+
+// The primary column of a block with the fewest rows, on which
+// components are branched before being split again.
+inline uint32 branching_column(const Block& block) {
+    std::vector<uint32> sizes(block.nprimary, 0);
+    for (size_t i = 0; i < block.columns.size(); i++) {
+        if (block.columns[i] < block.nprimary) {
+            sizes[block.columns[i]]++;
+        }
+    }
+    return std::min_element(sizes.begin(), sizes.end()) - sizes.begin();
+}
+
+// Count the covers of a block, component by component. While levels
+// remain, each component is branched on its primary column with the
+// fewest rows and what is left after each row is split again.
+inline uint64 count_block(const Block& block, uint32 levels, Arena& arena) {
+    std::vector<Block> components;
+    split(block, components);
+
+    uint64 total = 1;
+    for (size_t i = 0; i < components.size(); i++) {
+        const Block& component = components[i];
+        uint64 covers = 0;
+
+        if (levels == 0) {
+            covers = count(component, arena);
+        } else {
+            uint32 col = branching_column(component);
+            Block residual;
+            for (uint32 row = 0; row < component.rows(); row++) {
+                if (component(row, col)) {
+                    choose_row(component, row, residual);
+                    covers += count_block(residual, levels - 1, arena);
+                }
+            }
+        }
+
+        if (covers == 0) {
+            return 0;
+        }
+        total *= covers;
+    }
+    return total;
+}
+
+// Solve a block component by component, branching and splitting again
+// while levels remain, like count_block(). Rows of the instance forming
+// the exact cover are appended to the cover vector.
+inline bool solve_block(const Block& block, uint32 levels, Arena& arena,
+                        std::vector<uint32>& cover) {
+    std::vector<Block> components;
+    split(block, components);
+
+    std::vector<uint32> component_cover;
+    Block residual;
+    for (size_t i = 0; i < components.size(); i++) {
+        const Block& component = components[i];
+
+        if (levels == 0) {
+            if (!exact_cover::solve(component, arena, component_cover)) {
+                return false;
+            }
+            for (size_t j = 0; j < component_cover.size(); j++) {
+                cover.push_back(component.origin[component_cover[j]]);
+            }
+            continue;
+        }
+
+        uint32 col = branching_column(component);
+        size_t mark = cover.size();
+        bool solved = false;
+        for (uint32 row = 0; row < component.rows() && !solved; row++) {
+            if (component(row, col)) {
+                choose_row(component, row, residual);
+                solved = solve_block(residual, levels - 1, arena, cover);
+                if (solved) {
+                    cover.push_back(component.origin[row]);
+                } else {
+                    cover.resize(mark);
+                }
+            }
+        }
+        if (!solved) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Covers of a component, as rows of the instance,
+// laid out one after the other.
+struct CoverList {
+    CoverList() : starts(1, 0) {}
+
+    size_t size() const { return starts.size() - 1; }
+
+    // End the cover made of the rows added since the last one.
+    void close() { starts.push_back(rows.size()); }
+
+    std::vector<uint32> rows;       // Rows of each cover.
+    std::vector<size_t> starts;     // Start of each cover in rows, then the end.
+};
+
+// Append the covers it is handed to a list, after a given row.
+class CoverAppender {
+public:
+    CoverAppender(CoverList& list, uint32 row) : list(list), row(row) {}
+
+    bool operator()(const CoverView& cover) {
+        list.rows.push_back(row);
+        list.rows.insert(list.rows.end(), cover.begin(), cover.end());
+        list.close();
+        return true;
+    }
+
+private:
+    CoverList& list;
+    uint32 row;
+};
+
+// Hand each union of one cover per list to a visitor, walking their
+// product like an odometer, the last list moving fastest. Lists
+// mustn't be empty. Returns false if the visitor stopped the walk.
+template <typename Visitor>
+bool visit_unions(const std::vector<CoverList>& lists, Visitor& visitor) {
+    std::vector<size_t> chosen(lists.size(), 0);
+    std::vector<uint32> cover;
+    while (true) {
+        cover.clear();
+        for (size_t i = 0; i < lists.size(); i++) {
+            cover.insert(cover.end(), lists[i].rows.begin() + lists[i].starts[chosen[i]],
+                         lists[i].rows.begin() + lists[i].starts[chosen[i] + 1]);
+        }
+
+        const uint32* first = cover.empty() ? 0 : &cover[0];
+        if (!visitor(CoverView(first, first + cover.size()))) {
+            return false;
+        }
+
+        size_t i = lists.size();
+        while (i > 0 && ++chosen[i - 1] == lists[i - 1].size()) {
+            chosen[i - 1] = 0;
+            i--;
+        }
+        if (i == 0) {
+            return true;
+        }
+    }
+}
+
+// Collect every cover of a component into a list. While levels
+// remain, the component is branched like in count_block(), and the
+// covers left after each row are formed from those of the components
+// of the residual block.
+inline void collect_covers(const Block& component, uint32 levels, Arena& arena,
+                           CoverList& list) {
+    if (levels == 0) {
+        Search search(component, arena);
+        while (search.next()) {
+            for (CoverView::const_iterator it = search.cover().begin();
+                 it != search.cover().end(); ++it) {
+                list.rows.push_back(component.origin[*it]);
+            }
+            list.close();
+        }
+        return;
+    }
+
+    uint32 col = branching_column(component);
+    Block residual;
+    std::vector<Block> parts;
+    for (uint32 row = 0; row < component.rows(); row++) {
+        if (!component(row, col)) {
+            continue;
+        }
+        choose_row(component, row, residual);
+        split(residual, parts);
+
+        std::vector<CoverList> lists(parts.size());
+        bool covered = true;
+        for (size_t i = 0; i < parts.size() && covered; i++) {
+            collect_covers(parts[i], levels - 1, arena, lists[i]);
+            covered = lists[i].size() > 0;
+        }
+        if (covered) {
+            CoverAppender appender(list, component.origin[row]);
+            visit_unions(lists, appender);
+        }
+    }
+}
+
+} // namespace details
+
+// A connected component of an exact cover instance, see components().
+// It is a binary matrix, whose rows map back to those of the instance
+// through its origin member.
+typedef details::Block Component;
+
+// Split an exact cover instance into its connected components: the
+// sets of rows and columns linked by the nonzeros of the rows. Covers
+// of the instance are exactly the unions of one cover per component,
+// so components are best solved separately. See details::split().
+template <typename Matrix>
+void components(const Matrix& matrix, std::vector<Component>& parts) {
+    details::Block block;
+    details::collect_block(matrix, block);
+    details::split(block, parts);
+}
+
+// Count the exact covers of an instance as the product of the counts
+// of its components, which mustn't overflow. With levels above zero,
+// the components are also split again after each of the first levels
+// choices of rows, which pays off when choices disconnect instances.
+template <typename Matrix>
+uint64 count_components(const Matrix& matrix, uint32 levels = 0) {
+    details::Block block;
+    Arena arena;
+    details::collect_block(matrix, block);
+    return details::count_block(block, levels, arena);
+}
+
+// Solve an exact cover instance component by component, splitting
+// again after the first levels choices of rows, see count_components().
+// Indexes of the rows forming the exact cover are stored in the cover
+// vector. Returns whether a solution was found.
+template <typename Matrix>
+bool solve_components(const Matrix& matrix, std::vector<uint32>& cover,
+                      uint32 levels = 0) {
+    details::Block block;
+    Arena arena;
+    details::collect_block(matrix, block);
+    cover.clear();
+    if (!details::solve_block(block, levels, arena, cover)) {
+        cover.clear();
+        return false;
+    }
+    return true;
+}
+
+// Enumerate every exact cover of an instance component by component,
+// splitting again after the first levels choices of rows, see
+// count_components(), and enumerate() for the visitor protocol. The
+// covers of each component are kept in memory, while the covers of the
+// instance are only formed one at a time as the visitor asks for them.
+// Returns false if the enumeration was stopped by the visitor.
+template <typename Matrix, typename Visitor>
+bool enumerate_components(const Matrix& matrix, Visitor visitor, uint32 levels = 0) {
+    std::vector<Component> parts;
+    components(matrix, parts);
+
+    std::vector<details::CoverList> lists(parts.size());
+    Arena arena;
+    for (size_t i = 0; i < parts.size(); i++) {
+        details::collect_covers(parts[i], levels, arena, lists[i]);
+        if (lists[i].size() == 0) {
+            return true;
+        }
+    }
+    return details::visit_unions(lists, visitor);
+}
+
+} // namespace exact_cover
+
+#endif // EXACT_COVER_COMPONENTS_HPP_
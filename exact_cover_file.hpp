@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EXACT_COVER_FILE_HPP_
+#define EXACT_COVER_FILE_HPP_
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "types.hpp"
+#include "exact_cover.hpp"
+
+// Binary file format of exact cover instances. A file holds, in the
+// byte order of the machine which wrote it:
+//
+// - a header, see FileHeader;
+// - the start of each row in the column indexes, rows + 1 uint64;
+// - the column indexes of the nonzeros, row by row, as uint32.
+//
+// Each part is aligned on its own size, so the file can be mapped
+// in memory and used as is. Columns of a row are sorted.
+
+namespace exact_cover {
+
+namespace details {
+
+struct FileHeader {
+    char magic[4];          // "XCOV".
+    uint32 version;         // Version of the format, 1.
+    uint32 rows;            // Number of rows.
+    uint32 cols;            // Number of columns.
+    uint32 primary;         // Number of primary columns, which come first.
+    uint32 reserved;        // Zero.
+    uint64 nonzeros;        // Number of nonzeros.
+};
+
+const char file_magic[4] = { 'X', 'C', 'O', 'V' };
+const uint32 file_version = 1;
+
+} // namespace details
+
+// Write an exact cover instance encoded into a binary matrix to a
+// file, in the format read by InstanceFile. Throws std::runtime_error
+// if the file can't be written.
+template <typename Matrix>
+void write_instance(const Matrix& matrix, const std::string& path) {
+    std::vector<uint32> columns;
+    std::vector<uint32> offsets;
+    details::collect_nonzeros(matrix, columns, offsets);
+
+    details::FileHeader header;
+    std::memcpy(header.magic, details::file_magic, sizeof(header.magic));
+    header.version = details::file_version;
+    header.rows = matrix.rows();
+    header.cols = matrix.cols();
+    header.primary = details::primary_cols(matrix);
+    header.reserved = 0;
+    header.nonzeros = columns.size();
+
+    std::vector<uint64> starts(offsets.begin(), offsets.end());
+    for (uint32 row = 0; row < header.rows; row++) {
+        std::sort(columns.begin() + offsets[row], columns.begin() + offsets[row + 1]);
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == 0) {
+        throw std::runtime_error("Can't open " + path + " for writing!");
+    }
+
+    bool written =
+        std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(&starts[0], sizeof(uint64), starts.size(), file) == starts.size() &&
+        (columns.empty() ||
+         std::fwrite(&columns[0], sizeof(uint32), columns.size(), file) == columns.size());
+
+    if (std::fclose(file) != 0 || !written) {
+        throw std::runtime_error("Can't write " + path + "!");
+    }
+}
+
+// An exact cover instance read from a file written by write_instance.
+// The file is mapped in memory and used in place as a sparse binary
+// matrix, so opening it doesn't read the nonzeros into memory: they
+// are only copied once, by the building of a cover matrix. The file
+// is checked when it is opened: a malformed or truncated file, one
+// written on a machine of another byte order, or one holding more
+// nonzeros than a cover matrix can index, throws std::runtime_error.
+class InstanceFile {
+public:
+    typedef const uint32* nonzero_iterator;
+
+    explicit InstanceFile(const std::string& path) : data(0), length(0) {
+        map(path);
+
+        if (!check()) {
+            unmap();
+            throw std::runtime_error("Not an exact cover instance: " + path);
+        }
+
+        // Cover matrices index nonzeros with uint32.
+        if (header->nonzeros > std::numeric_limits<uint32>::max()) {
+            unmap();
+            throw std::runtime_error("Too many nonzeros in " + path);
+        }
+    }
+
+    ~InstanceFile() {
+        unmap();
+    }
+
+    bool operator()(uint32 row, uint32 col) const {
+        return std::binary_search(nonzero_begin(row), nonzero_end(row), col);
+    }
+
+    nonzero_iterator nonzero_begin(uint32 row) const {
+        return columns + starts[row];
+    }
+
+    nonzero_iterator nonzero_end(uint32 row) const {
+        return columns + starts[row + 1];
+    }
+
+    uint32 rows() const { return header->rows; }
+    uint32 cols() const { return header->cols; }
+    uint32 primary_cols() const { return header->primary; }
+    uint64 nonzeros() const { return header->nonzeros; }
+
+private:
+    InstanceFile(const InstanceFile&);
+    InstanceFile& operator=(const InstanceFile&);
+
+#if _WIN32
+    void map(const std::string& path) {
+        HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Can't open " + path + "!");
+        }
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(file, &size) ||
+            uint64(size.QuadPart) < sizeof(details::FileHeader) ||
+            uint64(size.QuadPart) > std::numeric_limits<size_t>::max()) {
+            ::CloseHandle(file);
+            throw std::runtime_error("Not an exact cover instance: " + path);
+        }
+
+        // The view keeps the file mapped once both handles are closed.
+        length = size_t(size.QuadPart);
+        HANDLE mapping = ::CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+        ::CloseHandle(file);
+        void* mapped = mapping != 0 ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+        if (mapping != 0) {
+            ::CloseHandle(mapping);
+        }
+        if (mapped == 0) {
+            throw std::runtime_error("Can't map " + path + "!");
+        }
+        data = static_cast<const char*>(mapped);
+    }
+
+    void unmap() {
+        ::UnmapViewOfFile(data);
+    }
+#else
+    void map(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Can't open " + path + "!");
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(details::FileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Not an exact cover instance: " + path);
+        }
+
+        length = info.st_size;
+        void* mapped = ::mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Can't map " + path + "!");
+        }
+        data = static_cast<const char*>(mapped);
+    }
+
+    void unmap() {
+        ::munmap(const_cast<char*>(data), length);
+    }
+#endif
+
+    // Locate the parts of the file and make sure that every
+    // nonzero lies within the matrix, in increasing columns.
+    bool check() {
+        header = reinterpret_cast<const details::FileHeader*>(data);
+        if (std::memcmp(header->magic, details::file_magic, sizeof(header->magic)) != 0 ||
+            header->version != details::file_version ||
+            header->primary > header->cols) {
+            return false;
+        }
+
+        // Bound the counts by the size of the file before
+        // using them, so that the sizes can't overflow.
+        uint64 left = length - sizeof(details::FileHeader);
+        if (uint64(header->rows) + 1 > left / sizeof(uint64)) {
+            return false;
+        }
+        left -= (uint64(header->rows) + 1) * sizeof(uint64);
+        if (header->nonzeros > left / sizeof(uint32) ||
+            left != header->nonzeros * sizeof(uint32)) {
+            return false;
+        }
+
+        starts = reinterpret_cast<const uint64*>(data + sizeof(details::FileHeader));
+        columns = reinterpret_cast<const uint32*>(starts + header->rows + 1);
+
+        if (starts[0] != 0 || starts[header->rows] != header->nonzeros) {
+            return false;
+        }
+        for (uint32 row = 0; row < header->rows; row++) {
+            if (starts[row] > starts[row + 1] || starts[row + 1] > header->nonzeros) {
+                return false;
+            }
+            for (uint64 i = starts[row]; i < starts[row + 1]; i++) {
+                if (columns[i] >= header->cols ||
+                    (i > starts[row] && columns[i] <= columns[i - 1])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const char* data;                       // The mapped file.
+    size_t length;                          // Size of the file.
+    const details::FileHeader* header;
+    const uint64* starts;                   // Start of each row in columns.
+    const uint32* columns;                  // Nonzero columns, row by row.
+};
+
+} // namespace exact_cover
+
+#endif // EXACT_COVER_FILE_HPP_
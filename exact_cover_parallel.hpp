@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EXACT_COVER_PARALLEL_HPP_
+#define EXACT_COVER_PARALLEL_HPP_
+
+#include <condition_variable>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+#include "types.hpp"
+#include "exact_cover.hpp"
+
+namespace exact_cover {
+
+namespace parallel {
+
+namespace details {
+
+using exact_cover::details::Node;
+
+// A branch of the search tree, given by the element chosen at each
+// level from the root. Elements are identified by their offset in
+// the arena, which is the same in every copy of the cover matrix
+// built from a given binary matrix, so that a branch found by a
+// worker can be replayed by any other.
+typedef std::vector<uint32> Branch;
+
+// Branches waiting to be explored, shared by every worker. Workers
+// lacking work wait on the pool, and busy workers split off their
+// unexplored branches as soon as the pool can't satisfy the demand.
+class WorkPool {
+public:
+    WorkPool() : active(0), demand(0), shortage(0), cancelled(false) {
+        branches.push_back(Branch());
+    }
+
+    // Retrieve a branch to explore, waiting for one to be published
+    // if need be. Returns false once the search is over, i.e. every
+    // worker is waiting or the search has been cancelled.
+    bool pop(Branch& branch) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (branches.empty() && active > 0 && !cancelled) {
+            demand++;
+            update();
+            available.wait(lock);
+            demand--;
+            update();
+        }
+
+        if (branches.empty() || cancelled) {
+            available.notify_all();
+            return false;
+        }
+
+        branch.swap(branches.front());
+        branches.pop_front();
+        update();
+        active++;
+        return true;
+    }
+
+    // Publish branches for idle workers to explore.
+    void push(std::vector<Branch>& published) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < published.size(); i++) {
+            branches.push_back(Branch());
+            branches.back().swap(published[i]);
+        }
+        update();
+        available.notify_all();
+    }
+
+    // Signal that the branch obtained by the last call to pop()
+    // has been fully explored.
+    void done() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--active == 0) {
+            available.notify_all();
+        }
+    }
+
+    // Stop every worker as soon as possible.
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        available.notify_all();
+    }
+
+    // Whether more workers wait than there are branches to give
+    // them. Cheap enough to be checked at every node of the search.
+    bool hungry() const {
+        return shortage.load(std::memory_order_relaxed) > 0;
+    }
+
+    bool stopped() const {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Refresh the shortage, with the mutex held.
+    void update() {
+        shortage.store(long(demand) - long(branches.size()),
+                       std::memory_order_relaxed);
+    }
+
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<Branch> branches;        // Branches yet to be explored.
+    size_t active;                      // Workers exploring a branch.
+    size_t demand;                      // Workers waiting for a branch.
+    std::atomic<long> shortage;         // Demand not met by the branches.
+    std::atomic<bool> cancelled;        // Whether the search is over.
+};
+
+// A worker owns its own copy of the cover matrix and repeatedly
+// explores the branches it gets from the pool. The exploration is the
+// same iterative search as exact_cover::Search, except that the
+// elements left to try at each level can be handed over to the pool,
+// in which case the level ends early. The handler is called for each
+// solution and returns false to stop the whole search. Columns are
+// chosen by the Policy, see exact_cover::BasicSearch.
+template <typename Handler, typename Policy>
+class Worker {
+public:
+    template <typename Matrix>
+    Worker(const Matrix& matrix, WorkPool& pool, const Handler& handler,
+           const Policy& policy) :
+        pool(pool), handler(handler), policy(policy) {
+        root = exact_cover::details::build_cover_matrix(matrix, arena);
+        this->policy.initialize(root);
+        rows.resize(matrix.cols() + 1);
+        choices.resize(matrix.cols() + 1);
+        limits.resize(matrix.cols() + 1);
+    }
+
+    void run() {
+        while (pool.pop(branch)) {
+            explore();
+            pool.done();
+        }
+    }
+
+    const Handler& result() const { return handler; }
+
+private:
+    // Replay the branch, explore the subtree below it and restore
+    // the cover matrix, unless the search gets cancelled midway.
+    void explore() {
+        size_t base = branch.size();
+        for (size_t i = 0; i < base; i++) {
+            Node* element = root + branch[i];
+            exact_cover::details::cover_column(element->header, policy);
+            exact_cover::details::cover_row(element, policy);
+            rows[i] = element->data;
+        }
+
+        size_t level = base;
+        bool descend = true;
+
+        while (!pool.stopped()) {
+            if (descend) {
+                if (root->right == root) {
+                    const uint32* first = &rows[0];
+                    if (!handler(CoverView(first, first + level))) {
+                        pool.cancel();
+                        return;
+                    }
+                    descend = false;
+                    continue;
+                }
+
+                Node* header = policy.choose(root);
+                exact_cover::details::cover_column(header, policy);
+                choices[level] = header->down;
+                limits[level] = header;
+            } else {
+                if (level == base) {
+                    break;
+                }
+
+                level--;
+                exact_cover::details::uncover_row(choices[level], policy);
+                choices[level] = choices[level]->down;
+            }
+
+            Node* element = choices[level];
+            if (element == limits[level]) {
+                exact_cover::details::uncover_column(element->header, policy);
+                descend = false;
+            } else {
+                exact_cover::details::cover_row(element, policy);
+                rows[level] = element->data;
+                level++;
+                descend = true;
+
+                if (pool.hungry()) {
+                    split(base, level);
+                }
+            }
+        }
+
+        if (pool.stopped()) {
+            return;
+        }
+
+        for (size_t i = base; i-- > 0;) {
+            Node* element = root + branch[i];
+            exact_cover::details::uncover_row(element, policy);
+            exact_cover::details::uncover_column(element->header, policy);
+        }
+    }
+
+    // Hand the untried elements of the shallowest level
+    // which still has some over to the pool.
+    void split(size_t base, size_t level) {
+        for (size_t l = base; l < level; l++) {
+            Node* next = choices[l]->down;
+            if (next == limits[l]) {
+                continue;
+            }
+
+            for (Node* element = next; element != limits[l]; element = element->down) {
+                published.push_back(branch);
+                for (size_t i = base; i < l; i++) {
+                    published.back().push_back(choices[i] - root);
+                }
+                published.back().push_back(element - root);
+            }
+
+            limits[l] = next;
+            pool.push(published);
+            published.clear();
+            return;
+        }
+    }
+
+    WorkPool& pool;
+    Handler handler;
+    Policy policy;
+    Arena arena;                    // Storage of this worker's cover matrix.
+    Node* root;                     // Root of this worker's cover matrix.
+    Branch branch;                  // Branch being explored.
+    std::vector<uint32> rows;       // Rows of the cover being searched.
+    std::vector<Node*> choices;     // Element tried at each level.
+    std::vector<Node*> limits;      // Element ending each level.
+    std::vector<Branch> published;  // Scratch: branches split off.
+};
+
+// Run a parallel search with the given number of workers, each
+// with its own copy of the handler. Returns the workers so that
+// their handlers can be inspected.
+template <typename Matrix, typename Handler, typename Policy>
+std::vector<std::unique_ptr<Worker<Handler, Policy> > > run(const Matrix& matrix,
+        const Handler& handler, size_t threads, const Policy& policy) {
+    WorkPool pool;
+    std::vector<std::unique_ptr<Worker<Handler, Policy> > > workers(std::max<size_t>(threads, 1));
+    std::vector<std::thread> pool_threads;
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        pool_threads.push_back(std::thread([&, i]() {
+            workers[i].reset(new Worker<Handler, Policy>(matrix, pool, handler, policy));
+            workers[i]->run();
+        }));
+    }
+
+    for (size_t i = 0; i < pool_threads.size(); i++) {
+        pool_threads[i].join();
+    }
+
+    return workers;
+}
+
+// Counts the solutions found by a worker.
+struct Counter {
+    Counter() : total(0) {}
+
+    bool operator()(const CoverView&) {
+        total++;
+        return true;
+    }
+
+    uint64 total;
+};
+
+// Records the first solution found by any worker.
+struct FirstCover {
+    FirstCover(std::mutex& mutex, std::vector<uint32>& cover, bool& found) :
+        mutex(mutex), cover(cover), found(found) {}
+
+    bool operator()(const CoverView& solution) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!found) {
+            cover.assign(solution.begin(), solution.end());
+            found = true;
+        }
+        return false;
+    }
+
+    std::mutex& mutex;
+    std::vector<uint32>& cover;
+    bool& found;
+};
+
+// Forwards every solution found by any worker to a visitor,
+// one at a time.
+template <typename Visitor>
+struct Serialized {
+    Serialized(std::mutex& mutex, Visitor& visitor, bool& stopped) :
+        mutex(mutex), visitor(visitor), stopped(stopped) {}
+
+    bool operator()(const CoverView& solution) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopped && !visitor(solution)) {
+            stopped = true;
+        }
+        return !stopped;
+    }
+
+    std::mutex& mutex;
+    Visitor& visitor;
+    bool& stopped;
+};
+
+} // namespace details
+
+// Number of workers used when none is specified.
+inline size_t default_threads() {
+    size_t threads = std::thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+// Solve an exact cover instance using several threads, each working
+// on its own copy of the cover matrix. Every worker is cancelled as
+// soon as one of them finds a solution, whose rows are returned. If
+// no solution exists, an empty vector is returned.
+template <typename Matrix, typename Policy = MinimumRemainingValues>
+std::vector<uint32> solve(const Matrix& matrix, size_t threads = default_threads(),
+                          const Policy& policy = Policy()) {
+    std::mutex mutex;
+    std::vector<uint32> cover;
+    bool found = false;
+
+    details::run(matrix, details::FirstCover(mutex, cover, found), threads, policy);
+    return cover;
+}
+
+// Count the exact covers of an instance using several threads.
+template <typename Matrix, typename Policy = MinimumRemainingValues>
+uint64 count(const Matrix& matrix, size_t threads = default_threads(),
+             const Policy& policy = Policy()) {
+    typedef std::unique_ptr<details::Worker<details::Counter, Policy> > worker_ptr;
+    std::vector<worker_ptr> workers =
+        details::run(matrix, details::Counter(), threads, policy);
+
+    uint64 total = 0;
+    for (size_t i = 0; i < workers.size(); i++) {
+        total += workers[i]->result().total;
+    }
+    return total;
+}
+
+// Enumerate every exact cover of an instance using several threads.
+// Calls to the visitor are serialized, but solutions come in no
+// particular order. See exact_cover::enumerate() for the visitor
+// protocol. Returns false if the enumeration was stopped.
+template <typename Matrix, typename Visitor,
+          typename Policy = MinimumRemainingValues>
+bool enumerate(const Matrix& matrix, Visitor visitor,
+               size_t threads = default_threads(),
+               const Policy& policy = Policy()) {
+    std::mutex mutex;
+    bool stopped = false;
+
+    details::run(matrix, details::Serialized<Visitor>(mutex, visitor, stopped),
+                 threads, policy);
+    return !stopped;
+}
+
+} // namespace parallel
+
+} // namespace exact_cover
+
+#endif // EXACT_COVER_PARALLEL_HPP_
@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EXACT_COVER_REDUCTION_HPP_
+#define EXACT_COVER_REDUCTION_HPP_
+
+#include <algorithm>
+#include <vector>
+
+#include "types.hpp"
+#include "exact_cover.hpp"
+
+namespace exact_cover {
+
+// What the reduction of an instance removed.
+struct ReductionReport {
+    ReductionReport() : forced_rows(0), removed_rows(0), removed_cols(0),
+        passes(0), infeasible(false) {}
+
+    uint32 forced_rows;     // Rows belonging to every cover.
+    uint32 removed_rows;    // Rows belonging to no cover.
+    uint32 removed_cols;    // Columns covered by forced rows, or empty.
+    uint32 passes;          // Passes over the columns until a fixpoint.
+    bool infeasible;        // Whether the instance has no cover.
+};
+
+// The core of an exact cover instance, left once the rows that must or
+// can't belong to a cover have been removed, along with the columns
+// they settle. The reduction repeatedly applies three rules until none
+// applies anymore:
+//
+// - A primary column without rows can't be covered: there's no cover.
+// - A primary column with a single row forces it into every cover,
+//   which removes its columns and the rows conflicting with it.
+// - If every row of a primary column c has another column d, the rows
+//   of d without c conflict with every way to cover c and are removed.
+//
+// The core is itself a binary matrix, primary columns first, to be
+// solved like any other. Covers of the core are turned back into
+// covers of the instance by expand().
+class Reduction {
+public:
+    typedef std::vector<uint32>::const_iterator nonzero_iterator;
+
+    template <typename Matrix>
+    explicit Reduction(const Matrix& matrix) {
+        details::collect_nonzeros(matrix, columns, offsets);
+        reduce(matrix.rows(), matrix.cols(), details::primary_cols(matrix));
+    }
+
+    bool operator()(uint32 row, uint32 col) const {
+        return std::find(nonzero_begin(row), nonzero_end(row), col) != nonzero_end(row);
+    }
+
+    nonzero_iterator nonzero_begin(uint32 row) const {
+        return core_columns.begin() + core_offsets[row];
+    }
+
+    nonzero_iterator nonzero_end(uint32 row) const {
+        return core_columns.begin() + core_offsets[row + 1];
+    }
+
+    uint32 rows() const { return core_rows.size(); }
+    uint32 cols() const { return core_cols; }
+    uint32 primary_cols() const { return core_primary; }
+
+    // Row of the instance matching a row of the core.
+    uint32 row(uint32 core_row) const { return core_rows[core_row]; }
+
+    // Rows of the instance belonging to every cover.
+    const std::vector<uint32>& forced() const { return forced_rows; }
+
+    const ReductionReport& report() const { return summary; }
+    bool infeasible() const { return summary.infeasible; }
+
+    // Turn a cover of the core into a cover of the instance, made of
+    // the forced rows followed by the rows of the core cover.
+    template <typename Cover>
+    void expand(const Cover& cover, std::vector<uint32>& rows) const {
+        std::vector<uint32> expanded(forced_rows);
+        for (typename Cover::const_iterator it = cover.begin(); it != cover.end(); ++it) {
+            expanded.push_back(core_rows[*it]);
+        }
+        rows.swap(expanded);
+    }
+
+private:
+    void reduce(uint32 rows, uint32 cols, uint32 primary) {
+        // Rows of each column, the transpose of columns and offsets.
+        std::vector<uint32> col_offsets(cols + 1, 0);
+        for (size_t i = 0; i < columns.size(); i++) {
+            col_offsets[columns[i] + 1]++;
+        }
+        for (uint32 col = 0; col < cols; col++) {
+            col_offsets[col + 1] += col_offsets[col];
+        }
+        std::vector<uint32> col_rows(columns.size());
+        std::vector<uint32> fill(col_offsets.begin(), col_offsets.end() - 1);
+        for (uint32 row = 0; row < rows; row++) {
+            for (uint32 i = offsets[row]; i < offsets[row + 1]; i++) {
+                col_rows[fill[columns[i]]++] = row;
+            }
+        }
+
+        row_alive.assign(rows, true);
+        col_alive.assign(cols, true);
+        sizes.assign(cols, 0);
+        for (size_t i = 0; i < columns.size(); i++) {
+            sizes[columns[i]]++;
+        }
+        std::vector<uint32> marks(rows, 0);
+        uint32 stamp = 0;
+
+        bool changed = true;
+        while (changed && !summary.infeasible) {
+            changed = false;
+            summary.passes++;
+
+            for (uint32 c = 0; c < primary; c++) {
+                if (!col_alive[c]) {
+                    continue;
+                }
+
+                if (sizes[c] == 0) {
+                    summary.infeasible = true;
+                    break;
+                }
+
+                if (sizes[c] == 1) {
+                    uint32 forced = first_row(col_rows, col_offsets, c);
+                    force(forced, col_rows, col_offsets);
+                    changed = true;
+                    continue;
+                }
+
+                // Look for the columns d sharing every row of c among
+                // those of one of its rows, then drop the rows of d
+                // outside of c.
+                stamp++;
+                for (uint32 i = col_offsets[c]; i < col_offsets[c + 1]; i++) {
+                    marks[col_rows[i]] = stamp;
+                }
+
+                uint32 first = first_row(col_rows, col_offsets, c);
+                for (uint32 i = offsets[first]; i < offsets[first + 1]; i++) {
+                    uint32 d = columns[i];
+                    if (d == c || sizes[d] <= sizes[c] ||
+                        !includes(c, d, col_rows, col_offsets)) {
+                        continue;
+                    }
+
+                    for (uint32 j = col_offsets[d]; j < col_offsets[d + 1]; j++) {
+                        uint32 row = col_rows[j];
+                        if (row_alive[row] && marks[row] != stamp) {
+                            remove_row(row);
+                            summary.removed_rows++;
+                        }
+                    }
+                    changed = true;
+                }
+            }
+        }
+
+        build_core(rows, cols, primary);
+    }
+
+    uint32 first_row(const std::vector<uint32>& col_rows,
+                     const std::vector<uint32>& col_offsets, uint32 col) const {
+        uint32 i = col_offsets[col];
+        while (!row_alive[col_rows[i]]) {
+            i++;
+        }
+        return col_rows[i];
+    }
+
+    // Whether every row left in column c is also in column d.
+    bool includes(uint32 c, uint32 d, const std::vector<uint32>& col_rows,
+                  const std::vector<uint32>& col_offsets) const {
+        for (uint32 i = col_offsets[c]; i < col_offsets[c + 1]; i++) {
+            uint32 row = col_rows[i];
+            if (row_alive[row] && !std::binary_search(col_rows.begin() + col_offsets[d],
+                                                      col_rows.begin() + col_offsets[d + 1], row)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void remove_row(uint32 row) {
+        row_alive[row] = false;
+        for (uint32 i = offsets[row]; i < offsets[row + 1]; i++) {
+            sizes[columns[i]]--;
+        }
+    }
+
+    // Put a row in the cover, removing its columns along with
+    // every row conflicting with it.
+    void force(uint32 row, const std::vector<uint32>& col_rows,
+               const std::vector<uint32>& col_offsets) {
+        forced_rows.push_back(row);
+        summary.forced_rows++;
+        remove_row(row);
+
+        for (uint32 i = offsets[row]; i < offsets[row + 1]; i++) {
+            uint32 col = columns[i];
+            for (uint32 j = col_offsets[col]; j < col_offsets[col + 1]; j++) {
+                if (row_alive[col_rows[j]]) {
+                    remove_row(col_rows[j]);
+                    summary.removed_rows++;
+                }
+            }
+            col_alive[col] = false;
+        }
+    }
+
+    // Renumber the columns and rows left, keeping their order. Empty
+    // secondary columns are dropped, as are empty rows since they
+    // never change a cover.
+    void build_core(uint32 rows, uint32 cols, uint32 primary) {
+        std::vector<uint32> renumbered(cols, 0);
+        core_cols = 0;
+        core_primary = 0;
+        for (uint32 col = 0; col < cols; col++) {
+            if (col_alive[col] && (col < primary || sizes[col] > 0)) {
+                renumbered[col] = core_cols++;
+                core_primary += col < primary;
+            }
+        }
+        summary.removed_cols = cols - core_cols;
+
+        core_rows.clear();
+        core_columns.clear();
+        core_offsets.assign(1, 0);
+        if (summary.infeasible) {
+            return;
+        }
+
+        for (uint32 row = 0; row < rows; row++) {
+            if (!row_alive[row]) {
+                continue;
+            }
+            if (offsets[row] == offsets[row + 1]) {
+                summary.removed_rows++;
+                continue;
+            }
+            for (uint32 i = offsets[row]; i < offsets[row + 1]; i++) {
+                core_columns.push_back(renumbered[columns[i]]);
+            }
+            core_rows.push_back(row);
+            core_offsets.push_back(core_columns.size());
+        }
+    }
+
+    std::vector<uint32> columns;        // Nonzero columns of the instance rows.
+    std::vector<uint32> offsets;        // Start of each row in columns.
+    std::vector<bool> row_alive;        // Rows left in the instance.
+    std::vector<bool> col_alive;        // Columns left in the instance.
+    std::vector<uint32> sizes;          // Rows left in each column.
+    std::vector<uint32> forced_rows;    // Rows forced into every cover.
+    std::vector<uint32> core_rows;      // Instance row of each core row.
+    std::vector<uint32> core_columns;   // Nonzero columns of the core rows.
+    std::vector<uint32> core_offsets;   // Start of each core row in core_columns.
+    uint32 core_cols;                   // Columns of the core.
+    uint32 core_primary;                // Primary columns of the core.
+    ReductionReport summary;
+};
+
+// Solve an exact cover instance after reducing it, see Reduction,
+// using the given arena to hold the cover matrix of the core. An
+// instance shown infeasible by the reduction is never searched.
+// Indexes of the rows forming the exact cover are stored in the
+// cover vector. Returns whether a solution was found.
+template <typename Matrix>
+bool solve_reduced(const Matrix& matrix, Arena& arena, std::vector<uint32>& cover,
+                   ReductionReport& report) {
+    Reduction core(matrix);
+    report = core.report();
+    cover.clear();
+    if (core.infeasible() || !solve(core, arena, cover)) {
+        cover.clear();
+        return false;
+    }
+    core.expand(cover, cover);
+    return true;
+}
+
+} // namespace exact_cover
+
+#endif // EXACT_COVER_REDUCTION_HPP_
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EXACT_COVER_TEXT_HPP_
+#define EXACT_COVER_TEXT_HPP_
+
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace exact_cover {
+
+// An exact cover instance read from text, in the input format of
+// Knuth's DLX programs. The first line names the columns, separated
+// by blanks, the primary ones first. A '|' separates them from the
+// secondary ones, if any. Every following line is a row, naming its
+// columns. Lines starting with '|' are comments and blank lines are
+// skipped. Names are interned, so the instance is a sparse binary
+// matrix whose rows can be printed back by name.
+//
+// Malformed input throws std::runtime_error, telling the line at
+// fault: a row naming an unknown column or the same column twice,
+// a column named twice, or colored columns, which aren't supported.
+class TextInstance {
+public:
+    typedef std::vector<uint32>::const_iterator nonzero_iterator;
+
+    explicit TextInstance(std::istream& in) : primary(0) {
+        std::string text;
+        std::vector<std::string> names;
+        bool header = true;
+        uint32 number = 0;
+
+        offsets.push_back(0);
+        while (std::getline(in, text)) {
+            number++;
+            if (!text.empty() && text[0] == '|') {
+                continue;
+            }
+
+            split(text, names);
+            if (names.empty()) {
+                continue;
+            }
+
+            if (header) {
+                read_columns(names, number);
+                header = false;
+            } else {
+                read_row(names, number);
+            }
+        }
+
+        if (header) {
+            throw std::runtime_error("No column names found!");
+        }
+    }
+
+    bool operator()(uint32 row, uint32 col) const {
+        return std::find(nonzero_begin(row), nonzero_end(row), col) != nonzero_end(row);
+    }
+
+    nonzero_iterator nonzero_begin(uint32 row) const {
+        return columns.begin() + offsets[row];
+    }
+
+    nonzero_iterator nonzero_end(uint32 row) const {
+        return columns.begin() + offsets[row + 1];
+    }
+
+    uint32 rows() const { return lines.size(); }
+    uint32 cols() const { return names.size(); }
+    uint32 primary_cols() const { return primary; }
+
+    // Name of a column.
+    const std::string& name(uint32 col) const { return names[col]; }
+
+    // Line of the input holding a row, counting from 1.
+    uint32 line(uint32 row) const { return lines[row]; }
+
+    // Names of the columns of a row, as given in the input.
+    std::string text(uint32 row) const {
+        std::string result;
+        for (nonzero_iterator it = nonzero_begin(row); it != nonzero_end(row); ++it) {
+            if (!result.empty()) {
+                result += ' ';
+            }
+            result += names[*it];
+        }
+        return result;
+    }
+
+private:
+    static void split(const std::string& text, std::vector<std::string>& words) {
+        words.clear();
+        size_t end = 0;
+        while (true) {
+            size_t start = text.find_first_not_of(" \t\r", end);
+            if (start == std::string::npos) {
+                return;
+            }
+            end = text.find_first_of(" \t\r", start);
+            words.push_back(text.substr(start, end - start));
+        }
+    }
+
+    static std::runtime_error error(uint32 number, const std::string& what) {
+        std::ostringstream message;
+        message << "Line " << number << ": " << what;
+        return std::runtime_error(message.str());
+    }
+
+    void read_columns(const std::vector<std::string>& words, uint32 number) {
+        bool secondary = false;
+        for (size_t i = 0; i < words.size(); i++) {
+            if (words[i] == "|" && !secondary) {
+                secondary = true;
+                continue;
+            }
+            if (words[i].find_first_of("|:") != std::string::npos) {
+                throw error(number, "bad column name " + words[i]);
+            }
+            if (!ids.insert(std::make_pair(words[i], uint32(names.size()))).second) {
+                throw error(number, "column " + words[i] + " named twice");
+            }
+            names.push_back(words[i]);
+            primary += !secondary;
+        }
+    }
+
+    void read_row(const std::vector<std::string>& words, uint32 number) {
+        size_t start = columns.size();
+        for (size_t i = 0; i < words.size(); i++) {
+            if (words[i].find(':') != std::string::npos) {
+                throw error(number, "colored columns aren't supported");
+            }
+
+            std::unordered_map<std::string, uint32>::const_iterator id = ids.find(words[i]);
+            if (id == ids.end()) {
+                throw error(number, "unknown column " + words[i]);
+            }
+            if (std::find(columns.begin() + start, columns.end(), id->second) != columns.end()) {
+                throw error(number, "column " + words[i] + " named twice");
+            }
+            columns.push_back(id->second);
+        }
+        offsets.push_back(columns.size());
+        lines.push_back(number);
+    }
+
+    std::unordered_map<std::string, uint32> ids;    // Column of each name.
+    std::vector<std::string> names;                 // Name of each column.
+    std::vector<uint32> columns;                    // Nonzero columns, row by row.
+    std::vector<uint32> offsets;                    // Start of each row in columns.
+    std::vector<uint32> lines;                      // Input line of each row.
+    uint32 primary;                                 // Number of primary columns.
+};
+
+} // namespace exact_cover
+
+#endif // EXACT_COVER_TEXT_HPP_
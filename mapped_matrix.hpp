@@ -74,8 +74,35 @@ class MappedMatrix {
 public:
     typedef T value_type;
 
+    // Iterates over the column indexes of the nonzero
+    // elements of a row, in increasing order.
+    class nonzero_iterator {
+    public:
+        typedef typename std::map<uint32, T>::const_iterator iterator;
+
+        nonzero_iterator(iterator iter) : iter(iter) {}
+
+        uint32 operator*() const { return iter->first; }
+
+        nonzero_iterator& operator++() {
+            ++iter;
+            return *this;
+        }
+
+        bool operator==(const nonzero_iterator& rhs) const {
+            return iter == rhs.iter;
+        }
+
+        bool operator!=(const nonzero_iterator& rhs) const {
+            return iter != rhs.iter;
+        }
+
+    private:
+        iterator iter;
+    };
+
     MappedMatrix(size_t row, size_t col) :
-        size(make_subscript(row, col)), zero() {
+        size(make_subscript<uint32>(row, col)), zero() {
         data.resize(row);
     }
 
@@ -99,6 +126,20 @@ public:
         return Proxy<MappedMatrix>(*this, make_subscript(row, col));
     }
 
+    nonzero_iterator nonzero_begin(uint32 row) const {
+        if (row >= size.row) {
+            throw std::invalid_argument("Invalid subscripts.");
+        }
+        return data[row].begin();
+    }
+
+    nonzero_iterator nonzero_end(uint32 row) const {
+        if (row >= size.row) {
+            throw std::invalid_argument("Invalid subscripts.");
+        }
+        return data[row].end();
+    }
+
     uint32 rows() const { return size.row; }
     uint32 cols() const { return size.col; }
 
@@ -139,7 +180,7 @@ private:
     T zero;                                 // The zero value for the current value type.
 };
 
-template <typename M, template <typename M> class Matrix>
+template <typename M, template <typename> class Matrix>
 std::ostream& operator<<(std::ostream& out, const Matrix<M>& m) {
     for (size_t i = 0; i < m.rows(); i++) {
         for (size_t j = 0; j < m.cols(); j++) {
@@ -19,6 +19,7 @@
 #define SUDOKU_H_
 
 #include <cctype>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <ostream>
@@ -104,6 +105,43 @@ std::ostream& operator<<(std::ostream& out, const Cell<Domain>& cell) {
          : out << char(value + 55);
 }
 
+// Outcome of reading a grid from characters, see Grid::parse().
+enum ParseStatus {
+    PARSED,         // The grid was read.
+    BAD_LENGTH,     // The text doesn't hold a character per cell.
+    BAD_CHARACTER   // A character isn't a value of the grid nor a blank.
+};
+
+namespace details {
+
+// Mapping between the values of cells and the characters standing
+// for them in grids, both ways. Blank and bad stand for unknown cells
+// and for characters which aren't allowed in grids.
+struct CharTable {
+    enum { blank = 0xfe, bad = 0xff };
+
+    static const CharTable& get() {
+        static const CharTable table;
+        return table;
+    }
+
+    CharTable() {
+        const char* characters = "0123456789abcdefghijklmnopqrstuvw";
+        std::fill(values, values + 256, uint8(bad));
+        for (uint8 value = 0; characters[value] != '\0'; value++) {
+            digits[value] = characters[value];
+            values[uint8(characters[value])] = value;
+            values[uint8(::toupper(characters[value]))] = value;
+        }
+        values[uint8('x')] = values[uint8('X')] = values[uint8(' ')] = blank;
+    }
+
+    uint8 values[256];  // Value of each character.
+    char digits[33];    // Character of each value.
+};
+
+} // namespace details
+
 // Again, the obvious thing, a Sudoku grid. At its core,
 // this is just a matrix of cells. No checks for validity
 // are performed on the cells, i.e. two cells could have
@@ -127,27 +165,62 @@ public:
         return *this;
     }
 
-    void operator<<(std::string grid) {
-        if (grid.size() != num_cells) {
+    // Read a grid from a string holding a character per cell, see
+    // parse(). Throws std::logic_error if the string isn't a grid.
+    void operator<<(const std::string& grid) {
+        switch (parse(grid.data(), grid.size())) {
+        case BAD_LENGTH:
             throw std::logic_error("Representation error !");
+        case BAD_CHARACTER:
+            throw std::logic_error("Value out of range!");
+        default:
+            break;
+        }
+    }
+
+    // Read a grid from num_cells characters, row by row: 'x' or ' '
+    // for unknown cells, '0' to '9' then 'a' to 'w', in either case,
+    // for values. Neither allocates nor throws. On error, the cells
+    // of the grid are left in an unspecified state.
+    ParseStatus parse(const char* text, size_t length) {
+        if (length != num_cells) {
+            return BAD_LENGTH;
         }
 
-        std::transform(grid.begin(), grid.end(), grid.begin(), ::tolower);
+        const details::CharTable& table = details::CharTable::get();
+        for (uint16 row = 0; row < size; row++) {
+            for (uint16 col = 0; col < size; col++) {
+                uint8 value = table.values[uint8(*text++)];
+                if (value == details::CharTable::blank) {
+                    cells[row][col].reset();
+                } else if (value < size) {
+                    cells[row][col].set(value);
+                } else {
+                    return BAD_CHARACTER;
+                }
+            }
+        }
+        return PARSED;
+    }
 
-        for (uint16 i = 0; i < num_cells; i++) {
-            uint16 row = i / size;
-            uint16 col = i % size;
+    // Write the grid as read by parse(), values in lower case. Returns
+    // the number of characters written, num_cells, or 0 if they don't
+    // fit in length characters. No terminating nul is written.
+    size_t format(char* text, size_t length) const {
+        static_assert(size <= 33, "Values past 'w' have no character.");
+        if (length < num_cells) {
+            return 0;
+        }
 
-            if (grid[i] == 'x' || grid[i] == ' ') {
-                cells[row][col].reset();
-            } else if ('a' <= grid[i] && grid[i] <= 'w') {
-                cells[row][col] = uint16(grid[i] - 87);
-            } else if ('0' <= grid[i] && grid[i] <= '9') {
-                cells[row][col] = uint16(grid[i] - 48);
-            } else {
-                throw std::logic_error("Value out of range!");
+        const details::CharTable& table = details::CharTable::get();
+        for (uint16 row = 0; row < size; row++) {
+            for (uint16 col = 0; col < size; col++) {
+                *text++ = cells[row][col].setted()
+                        ? table.digits[cells[row][col].get()]
+                        : 'x';
             }
         }
+        return num_cells;
     }
 
     Cell<size>& operator()(uint16 row, uint16 col) {
@@ -168,6 +241,65 @@ protected:
     Cell<size> cells[size][size];   // A grid is just a matrix of cells.
 };
 
+// Read grids from records of num_cells characters, see Grid::parse(),
+// either on lines of their own or back to back. Blank lines are
+// skipped, while a line which isn't made of whole records gives a
+// single BAD_LENGTH, so that records keep matching the lines they
+// come from. Up to count records are read into grids, along with
+// their status. Returns the number of records read, whose text is
+// counted in consumed, if given, so that the rest of the text can be
+// carried over to the next call. Since a line left unterminated at
+// the end of the text may go on in the next buffer, it is only read
+// once the caller tells that the input ends there, through last.
+template <uint16 Row, uint16 Col>
+size_t parse_records(const char* text, size_t length, Grid<Row, Col>* grids,
+                     ParseStatus* status, size_t count, size_t* consumed = 0,
+                     bool last = false) {
+    const size_t cells = Grid<Row, Col>::num_cells;
+    const char* end = text + length;
+    const char* start = text;
+    const char* line_end = 0;   // Line break ending the current line, or end.
+    size_t records = 0;
+
+    while (records < count) {
+        while (text != end && (*text == '\n' || *text == '\r')) {
+            text++;
+        }
+        if (text == end) {
+            break;
+        }
+
+        // Find the end of a new line only once it is reached,
+        // so that back to back records are scanned only once.
+        if (line_end == 0 || text > line_end) {
+            line_end = static_cast<const char*>(std::memchr(text, '\n', end - text));
+            if (line_end == 0) {
+                line_end = end;
+            }
+        }
+        if (line_end == end && !last) {
+            break;
+        }
+
+        size_t left = line_end - text;
+        left -= line_end[-1] == '\r';
+        if (left % cells != 0) {
+            status[records++] = BAD_LENGTH;
+            text = line_end == end ? end : line_end + 1;
+            continue;
+        }
+
+        status[records] = grids[records].parse(text, cells);
+        records++;
+        text += cells;
+    }
+
+    if (consumed != 0) {
+        *consumed = text - start;
+    }
+    return records;
+}
+
 template <uint16 Row, uint16 Col>
 bool operator==(const Grid<Row, Col>& a, const Grid<Row, Col>& b) {
     for (uint16 i = 0; i < Grid<Row, Col>::size; ++i) {
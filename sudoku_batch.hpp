@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef SUDOKU_BATCH_HPP_
+#define SUDOKU_BATCH_HPP_
+
+#include <condition_variable>
+#include <algorithm>
+#include <iterator>
+#include <istream>
+#include <ostream>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "types.hpp"
+#include "sudoku.hpp"
+#include "sudoku_solver_ng.hpp"
+
+namespace sudoku {
+
+// What a batch went through, see solve_batch().
+struct BatchReport {
+    BatchReport() : puzzles(0), solved(0), unsolvable(0), malformed(0), seconds(0) {}
+
+    double puzzles_per_second() const {
+        return seconds > 0 ? puzzles / seconds : 0;
+    }
+
+    uint64 puzzles;     // Lines read.
+    uint64 solved;      // Puzzles with a solution.
+    uint64 unsolvable;  // Puzzles without solution.
+    uint64 malformed;   // Lines which aren't a grid.
+    double seconds;     // Time spent on the whole batch.
+};
+
+namespace details {
+
+// Puzzles of a batch read at once, as records of one character per
+// cell, along with their solutions written back the same way.
+struct Chunk {
+    enum Outcome { SOLVED, UNSOLVABLE, MALFORMED };
+
+    Chunk() : size(0) {}
+
+    std::vector<char> puzzles;      // A record per puzzle.
+    std::vector<char> solutions;    // A record per puzzle.
+    std::vector<uint8> outcomes;    // Outcome of each puzzle.
+    size_t size;                    // Number of puzzles.
+};
+
+// Fill a chunk with up to capacity lines of the input, reading each
+// one into the line buffer, which holds a record and a line break at
+// most. Lines which don't hold a cell per character are only marked
+// as malformed, the rest of longer ones being skipped unread.
+template <uint16 Row, uint16 Col>
+void read_chunk(std::istream& in, size_t capacity, std::string& line, Chunk& chunk) {
+    const size_t cells = Grid<Row, Col>::num_cells;
+    chunk.puzzles.resize(capacity * cells);
+    chunk.solutions.resize(capacity * cells);
+    chunk.outcomes.resize(capacity);
+    line.resize(cells + 2);
+
+    chunk.size = 0;
+    while (chunk.size < capacity) {
+        in.getline(&line[0], line.size());
+        size_t length = in.gcount();
+        if (in.fail()) {
+            if (length == 0) {
+                break;
+            }
+            // The line didn't fit, it can't be a record.
+            in.clear();
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            length = 0;
+        } else if (!in.eof()) {
+            length--;   // The line break.
+        }
+
+        if (length > 0 && line[length - 1] == '\r') {
+            length--;
+        }
+        if (length == cells) {
+            std::copy(line.begin(), line.begin() + cells,
+                      chunk.puzzles.begin() + chunk.size * cells);
+            chunk.outcomes[chunk.size] = Chunk::SOLVED;
+        } else {
+            chunk.outcomes[chunk.size] = Chunk::MALFORMED;
+        }
+        chunk.size++;
+    }
+}
+
+// Write the solution of each puzzle of a chunk, in order, a line of
+// blanks standing for puzzles without solution or malformed.
+template <uint16 Row, uint16 Col>
+void write_chunk(const Chunk& chunk, std::ostream& out, BatchReport& report) {
+    const size_t cells = Grid<Row, Col>::num_cells;
+    for (size_t i = 0; i < chunk.size; i++) {
+        if (chunk.outcomes[i] == Chunk::SOLVED) {
+            out.write(&chunk.solutions[i * cells], cells);
+            report.solved++;
+        } else {
+            std::fill_n(std::ostreambuf_iterator<char>(out), cells, 'x');
+            report.unsolvable += chunk.outcomes[i] == Chunk::UNSOLVABLE;
+            report.malformed += chunk.outcomes[i] == Chunk::MALFORMED;
+        }
+        out.put('\n');
+    }
+    report.puzzles += chunk.size;
+}
+
+// Threads solving the puzzles of one chunk at a time, each with its
+// own Solver built once and reused for every puzzle. Puzzles are
+// handed out one by one, so that hard ones don't hold up a thread
+// while the others are idle.
+template <uint16 Row, uint16 Col>
+class BatchPool {
+public:
+    explicit BatchPool(size_t threads) :
+        chunk(0), generation(0), busy(0), stopping(false) {
+        for (size_t i = 0; i < std::max<size_t>(threads, 1); i++) {
+            workers.push_back(std::thread(&BatchPool::work, this));
+        }
+    }
+
+    ~BatchPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        started.notify_all();
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+    }
+
+    // Have the threads solve the puzzles of a chunk, which must
+    // be left alone until wait() returns.
+    void start(Chunk& puzzles) {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunk = &puzzles;
+        next = 0;
+        busy = workers.size();
+        generation++;
+        started.notify_all();
+    }
+
+    // Wait until every puzzle of the chunk given to start() is solved.
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (busy > 0) {
+            finished.wait(lock);
+        }
+    }
+
+private:
+    BatchPool(const BatchPool&);
+    BatchPool& operator=(const BatchPool&);
+
+    void work() {
+        Solver<Row, Col> solver;
+        Grid<Row, Col> puzzle;
+        Grid<Row, Col> solution;
+        uint64 seen = 0;
+
+        while (true) {
+            Chunk* current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!stopping && generation == seen) {
+                    started.wait(lock);
+                }
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                current = chunk;
+            }
+
+            for (size_t i = next++; i < current->size; i = next++) {
+                if (current->outcomes[i] == Chunk::MALFORMED) {
+                    continue;
+                }
+                const size_t cells = Grid<Row, Col>::num_cells;
+                if (puzzle.parse(&current->puzzles[i * cells], cells) != PARSED) {
+                    current->outcomes[i] = Chunk::MALFORMED;
+                    continue;
+                }
+
+                solution = solver(puzzle);
+                if (solution(0, 0).setted()) {
+                    solution.format(&current->solutions[i * cells], cells);
+                } else {
+                    current->outcomes[i] = Chunk::UNSOLVABLE;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable started;    // A chunk was handed out, or stopping.
+    std::condition_variable finished;   // Every thread is done with the chunk.
+    Chunk* chunk;                       // Chunk being solved.
+    std::atomic<size_t> next;           // Next puzzle of the chunk to solve.
+    uint64 generation;                  // Number of chunks handed out.
+    size_t busy;                        // Threads still on the chunk.
+    bool stopping;
+};
+
+} // namespace details
+
+// Solve a batch of puzzles, one per line of the input, writing their
+// solutions to the output in the same order, one per line. Puzzles are
+// written like Grid reads them, a character per cell. A line of blanks
+// ('x') stands for a puzzle without solution or a malformed line.
+//
+// The input is read chunk_size lines at a time, in fixed size records,
+// and each chunk is solved by a pool of threads while the next one is
+// read, so memory use only depends on the chunk size.
+template <uint16 Row, uint16 Col>
+BatchReport solve_batch(std::istream& in, std::ostream& out,
+                        size_t threads = std::thread::hardware_concurrency(),
+                        size_t chunk_size = 4096) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BatchReport report;
+    details::Chunk chunks[2];
+    details::Chunk* solving = &chunks[0];
+    details::Chunk* reading = &chunks[1];
+    details::BatchPool<Row, Col> pool(threads);
+    std::string line;
+
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    details::read_chunk<Row, Col>(in, chunk_size, line, *solving);
+    while (solving->size > 0) {
+        pool.start(*solving);
+        details::read_chunk<Row, Col>(in, chunk_size, line, *reading);
+        pool.wait();
+
+        details::write_chunk<Row, Col>(*solving, out, report);
+        std::swap(solving, reading);
+    }
+
+    report.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+} // namespace sudoku
+
+#endif // SUDOKU_BATCH_HPP_
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef SUDOKU_GENERATOR_HPP_
+#define SUDOKU_GENERATOR_HPP_
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "types.hpp"
+#include "sudoku.hpp"
+#include "sudoku_solver_ng.hpp"
+
+namespace sudoku {
+
+// Generates random minimal puzzles: grids with a unique solution
+// which lose it as soon as any of their givens is removed. Every
+// uniqueness check restarts the search of a single Solver, so the
+// cover matrix is only built once per generator.
+template <uint16 Row, uint16 Col>
+class Generator {
+public:
+    explicit Generator(uint64 seed = 1) : random(seed) {}
+
+    // Restart the random sequence from a seed.
+    void reseed(uint64 seed) {
+        random.seed(seed);
+    }
+
+    // A random full grid: the solution of a grid whose first row is a
+    // random permutation of the values, with its rows shuffled within
+    // bands of regions and the bands themselves, and likewise for its
+    // columns, all of which keeps it valid.
+    Grid<Row, Col> full_grid() {
+        Grid<Row, Col> first_row;
+        shuffle(1, Grid<Row, Col>::size, values);
+        for (uint16 col = 0; col < Grid<Row, Col>::size; col++) {
+            first_row(0, col) = values[col];
+        }
+        Grid<Row, Col> solved = solver(first_row);
+
+        Grid<Row, Col> full;
+        shuffle(Col, Row, rows);
+        shuffle(Row, Col, cols);
+        for (uint16 row = 0; row < Grid<Row, Col>::size; row++) {
+            for (uint16 col = 0; col < Grid<Row, Col>::size; col++) {
+                full(row, col) = solved(rows[row], cols[col]);
+            }
+        }
+        return full;
+    }
+
+    // A minimal puzzle whose solution is the given full grid, made by
+    // removing its cells in random order, unless the grid left would
+    // have several solutions. A given kept that way stays needed as
+    // more are removed, since removing givens only adds solutions.
+    Grid<Row, Col> minimize(const Grid<Row, Col>& solution) {
+        Grid<Row, Col> puzzle = solution;
+        shuffle(1, Grid<Row, Col>::num_cells, cells);
+        for (uint32 i = 0; i < cells.size(); i++) {
+            uint16 row = cells[i] / Grid<Row, Col>::size;
+            uint16 col = cells[i] % Grid<Row, Col>::size;
+            uint16 value = puzzle(row, col).get();
+
+            puzzle(row, col).reset();
+            if (solver.count(puzzle, 2) != 1) {
+                puzzle(row, col) = value;
+            }
+        }
+        return puzzle;
+    }
+
+    // A random minimal puzzle.
+    Grid<Row, Col> operator()() {
+        return minimize(full_grid());
+    }
+
+private:
+    Generator(const Generator&);
+    Generator& operator=(const Generator&);
+
+    // Shuffle groups of span consecutive numbers, and the
+    // numbers of each group, e.g. rows within bands.
+    template <typename Number>
+    void shuffle(uint32 groups, uint32 span, std::vector<Number>& order) {
+        std::vector<uint32>& group = scratch;
+        group.resize(groups);
+        std::iota(group.begin(), group.end(), 0);
+        std::shuffle(group.begin(), group.end(), random);
+
+        order.resize(groups * span);
+        for (uint32 i = 0; i < groups; i++) {
+            typename std::vector<Number>::iterator first = order.begin() + i * span;
+            std::iota(first, first + span, group[i] * span);
+            std::shuffle(first, first + span, random);
+        }
+    }
+
+    Solver<Row, Col> solver;
+    std::mt19937_64 random;
+    std::vector<uint16> values;     // Scratch: the first row of a grid.
+    std::vector<uint16> rows;       // Scratch: order of the rows of a grid.
+    std::vector<uint16> cols;       // Scratch: order of the columns of a grid.
+    std::vector<uint32> cells;      // Scratch: order of the cells of a grid.
+    std::vector<uint32> scratch;    // Scratch: order of the groups to shuffle.
+};
+
+// Generate count random minimal puzzles using several threads, each
+// with its own Generator. Puzzle i only depends on the seed and on i,
+// so the puzzles are the same whatever the number of threads.
+template <uint16 Row, uint16 Col>
+void generate(std::vector<Grid<Row, Col> >& puzzles, size_t count, uint64 seed = 1,
+              size_t threads = std::thread::hardware_concurrency()) {
+    puzzles.resize(count);
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+
+    threads = std::max<size_t>(std::min(threads, count), 1);
+    for (size_t t = 0; t < threads; t++) {
+        pool.push_back(std::thread([&]() {
+            Generator<Row, Col> generator;
+            for (size_t i = next++; i < count; i = next++) {
+                generator.reseed(seed + i * 0x9e3779b97f4a7c15ULL);
+                puzzles[i] = generator();
+            }
+        }));
+    }
+    for (size_t t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+}
+
+} // namespace sudoku
+
+#endif // SUDOKU_GENERATOR_HPP_
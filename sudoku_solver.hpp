@@ -30,20 +30,16 @@
 
 namespace sudoku {
 
-template <uint16 Row, uint16 Col>
-Grid<Row, Col> solve(const Grid<Row, Col>& sudoku) {
-    // The solution to an exact cover problem is a list of row
-    // indexes. We need a way to map those indexes to a value and
-    // the corresponding cell in the Sudoku's grid. Thus the need
-    // for this vector which, given a row index, allow us to find
-    // the associated cell and its value in the solved grid.
-    std::vector<std::pair<Subscript<uint16>, uint16> > index;
+// Cell and value of each row of the exact cover instance of a grid.
+typedef std::vector<std::pair<Subscript<uint16>, uint16> > CoverIndex;
 
-    // A sparse matrix large enough to old the exact cover instance.
-    // Since it's a sparse matrix, we don't have to pay for this
-    // excess storage.
-    MappedMatrix<bool> bmatrix(power<Grid<Row, Col>::size, 3>::value,
-                               power<Grid<Row, Col>::size, 2>::value * 4);
+// Fill the binary matrix of the exact cover instance of a grid, which
+// must be large enough to hold it, see solve(), and the index giving
+// the cell and the value of each of its rows.
+template <uint16 Row, uint16 Col>
+void encode(const Grid<Row, Col>& sudoku, MappedMatrix<bool>& bmatrix,
+            CoverIndex& index) {
+    index.clear();
 
     uint32 irow = 0; // Instance matrix row index.
 
@@ -93,6 +89,23 @@ Grid<Row, Col> solve(const Grid<Row, Col>& sudoku) {
             }
         }
     }
+}
+
+template <uint16 Row, uint16 Col>
+Grid<Row, Col> solve(const Grid<Row, Col>& sudoku) {
+    // The solution to an exact cover problem is a list of row
+    // indexes. We need a way to map those indexes to a value and
+    // the corresponding cell in the Sudoku's grid. Thus the need
+    // for this vector which, given a row index, allow us to find
+    // the associated cell and its value in the solved grid.
+    CoverIndex index;
+
+    // A sparse matrix large enough to old the exact cover instance.
+    // Since it's a sparse matrix, we don't have to pay for this
+    // excess storage.
+    MappedMatrix<bool> bmatrix(power<Grid<Row, Col>::size, 3>::value,
+                               power<Grid<Row, Col>::size, 2>::value * 4);
+    encode(sudoku, bmatrix, index);
 
     Grid<Row, Col> solution;
     std::vector<uint32> cover(exact_cover::solve(bmatrix));
@@ -18,7 +18,9 @@
 #ifndef SUDOKU_SOLVER_HPP_
 #define SUDOKU_SOLVER_HPP_
 
+#include <algorithm>
 #include <utility>
+#include <limits>
 #include <vector>
 
 #include "types.hpp"
@@ -29,9 +31,170 @@
 
 namespace sudoku {
 
+namespace details {
+
+// Values placed in each row, column and region of a grid, as bitmasks.
+// Regions are numbered like in SudokuBinaryMatrix.
+template <uint16 Row, uint16 Col>
+class Placed {
+public:
+    static const uint16 size = Grid<Row, Col>::size;
+    static const uint64 all = size < 64 ? (uint64(1) << size) - 1 : ~uint64(0);
+
+    Placed() {
+        std::fill(masks, masks + 3 * size, 0);
+    }
+
+    static uint16 region(uint16 row, uint16 col) {
+        return row / Row + col / Col * Col;
+    }
+
+    // Cell number i of a unit: rows, then columns, then regions.
+    static Subscript<uint16> cell(uint16 unit, uint16 i) {
+        if (unit < size) {
+            return Subscript<uint16>(unit, i);
+        } else if (unit < 2 * size) {
+            return Subscript<uint16>(i, unit - size);
+        }
+        uint16 region = unit - 2 * size;
+        return Subscript<uint16>(region % Col * Row + i / Col,
+                                 region / Col * Col + i % Col);
+    }
+
+    // Start from the givens of a grid. Returns false if two
+    // of them share a row, a column or a region.
+    bool start(const Grid<Row, Col>& grid) {
+        std::fill(masks, masks + 3 * size, 0);
+        for (uint16 row = 0; row < size; row++) {
+            for (uint16 col = 0; col < size; col++) {
+                if (grid(row, col).setted() && !place(row, col, grid(row, col).get())) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Place a value in a cell, unless its row, column
+    // or region already holds it.
+    bool place(uint16 row, uint16 col, uint16 value) {
+        uint64 bit = uint64(1) << value;
+        uint64& in_region = masks[2 * size + region(row, col)];
+        if ((masks[row] | masks[size + col] | in_region) & bit) {
+            return false;
+        }
+        masks[row] |= bit;
+        masks[size + col] |= bit;
+        in_region |= bit;
+        return true;
+    }
+
+    // Values which can still go in a cell.
+    uint64 candidates(uint16 row, uint16 col) const {
+        return all & ~(masks[row] | masks[size + col] | masks[2 * size + region(row, col)]);
+    }
+
+    // Values placed in a unit, numbered like in cell().
+    uint64 unit(uint16 index) const { return masks[index]; }
+
+private:
+    uint64 masks[3 * size];     // Rows, then columns, then regions.
+};
+
+} // namespace details
+
+// Fill the cells of a grid that follow from the cells already set, by
+// constraint propagation: naked singles, cells with a single candidate
+// value left, and hidden singles, values with a single candidate cell
+// left in a row, a column or a region. Returns false if the grid turns
+// out to have no solution, in which case it is left partly filled.
+template <uint16 Row, uint16 Col>
+bool propagate(Grid<Row, Col>& grid, details::Placed<Row, Col>& placed) {
+    const uint16 size = Grid<Row, Col>::size;
+    if (!placed.start(grid)) {
+        return false;
+    }
+
+    uint64 candidates[size];
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (uint16 row = 0; row < size; row++) {
+            for (uint16 col = 0; col < size; col++) {
+                if (grid(row, col).setted()) {
+                    continue;
+                }
+                uint64 values = placed.candidates(row, col);
+                if (values == 0) {
+                    return false;
+                }
+                if ((values & (values - 1)) == 0) {
+                    uint16 value = exact_cover::details::lowest_bit(values);
+                    placed.place(row, col, value);
+                    grid(row, col).set(value);
+                    changed = true;
+                }
+            }
+        }
+
+        for (uint16 unit = 0; unit < 3 * size; unit++) {
+            // Values which are candidates of one cell, of two or more.
+            uint64 once = 0, twice = 0;
+            for (uint16 i = 0; i < size; i++) {
+                Subscript<uint16> cell = placed.cell(unit, i);
+                candidates[i] = grid(cell.row, cell.col).setted() ? 0 :
+                                placed.candidates(cell.row, cell.col);
+                twice |= once & candidates[i];
+                once |= candidates[i];
+            }
+
+            if ((once | placed.unit(unit)) != placed.all) {
+                return false;
+            }
+
+            uint64 hidden = once & ~twice;
+            for (uint16 i = 0; i < size && hidden != 0; i++) {
+                uint64 values = candidates[i] & hidden;
+                if (values == 0) {
+                    continue;
+                }
+                Subscript<uint16> cell = placed.cell(unit, i);
+                uint16 value = exact_cover::details::lowest_bit(values);
+                if ((values & (values - 1)) != 0 || !placed.place(cell.row, cell.col, value)) {
+                    return false;
+                }
+                grid(cell.row, cell.col).set(value);
+                hidden &= ~values;
+                changed = true;
+            }
+        }
+    }
+    return true;
+}
+
+template <uint16 Row, uint16 Col>
+bool propagate(Grid<Row, Col>& grid) {
+    details::Placed<Row, Col> placed;
+    return propagate(grid, placed);
+}
+
+// The binary matrix of the exact cover instance of a grid. The grid is
+// first completed by propagate(), and only the cells left unknown make
+// it into the matrix, with the values they can still take. Columns of
+// the cells, and of the values placed in rows, columns and regions,
+// which are already settled are left out as well. Cells of the grid
+// are thus found either in known() or in a cover of the matrix.
+//
+// Propagation works on bitmasks, limiting grids to 64 values per cell.
 template <uint16 Row, uint16 Col>
 class SudokuBinaryMatrix {
 public:
+    static_assert(Grid<Row, Col>::size <= 64, "Grids are limited to 64 values per cell.");
+
+    // Each row has exactly four nonzeros, stored in its descriptor.
+    typedef const uint32* nonzero_iterator;
+
     struct RowDescriptor {
         RowDescriptor(uint16 row, uint16 col, uint16 value,
             uint32 col0, uint32 col1, uint32 col2, uint32 col3) :
@@ -47,42 +210,59 @@ public:
         uint32 cols[4];
     };
 
+    SudokuBinaryMatrix() : ncols(0), feasible(true) {}
+
     void operator<<(const Grid<Row, Col>& grid) {
-        mrows.clear();
+        const uint16 size = Grid<Row, Col>::size;
+        const uint32 cells = Grid<Row, Col>::num_cells;
 
-        for (uint16 row = 0; row < Grid<Row, Col>::size; row++) {
-            for (uint16 col = 0; col < Grid<Row, Col>::size; col++) {
-                // Current region index for this cell.
-                uint16 region = row / Grid<Row, Col>::rows +
-                                col / Grid<Row, Col>::columns *
-                                      Grid<Row, Col>::columns;
+        mrows.clear();
+        mknown = grid;
+        feasible = propagate(mknown, placed);
+        if (!feasible) {
+            // A single column without rows: there's no cover.
+            ncols = 1;
+            return;
+        }
 
-                // Cell's domain start and stop values.
-                uint16 start = 0;
-                uint16 stop = Grid<Row, Col>::size;
+        // Number the columns left in order: those of the cells, then
+        // of the values of each row, column and region.
+        renumbered.resize(4 * cells);
+        ncols = 0;
+        for (uint32 col = 0; col < 4 * cells; col++) {
+            uint16 quarter = col / cells;
+            uint16 unit = col % cells / size;
+            uint16 value = col % size;
+            bool settled = quarter == 0
+                         ? mknown(unit, value).setted()
+                         : (placed.unit((quarter - 1) * size + unit) >> value) & 1;
+            renumbered[col] = settled ? 0 : ncols++;
+        }
 
-                // If the cell's value is known, its
-                // domain boils down this single value.
-                if (grid(row, col).setted()) {
-                    start = grid(row, col).get();
-                    stop = start + 1;
+        for (uint16 row = 0; row < size; row++) {
+            for (uint16 col = 0; col < size; col++) {
+                if (mknown(row, col).setted()) {
+                    continue;
                 }
 
-                // For each value in the cell domain, fill a row in
-                // the sparse matrix representing the exact cover
+                // Current region index for this cell.
+                uint16 region = placed.region(row, col);
+
+                // For each value the cell can still take, fill a row
+                // in the sparse matrix representing the exact cover
                 // problem instance.
-                for (uint16 value = start; value < stop; value++) {
-                    uint16 col0 = Grid<Row, Col>::num_cells * 0 +
-                                  Grid<Row, Col>::size * row + col;
-                    uint16 col1 = Grid<Row, Col>::num_cells * 1 +
-                                  Grid<Row, Col>::size * row + value;
-                    uint16 col2 = Grid<Row, Col>::num_cells * 2 +
-                                  Grid<Row, Col>::size * col + value;
-                    uint16 col3 = Grid<Row, Col>::num_cells * 3 +
-                         region * Grid<Row, Col>::size + value;
-
-                    mrows.push_back(RowDescriptor(row, col, value, col0,
-                                                  col1, col2, col3));
+                uint64 values = placed.candidates(row, col);
+                while (values != 0) {
+                    uint16 value = exact_cover::details::lowest_bit(values);
+                    values &= values - 1;
+
+                    uint32 col0 = cells * 0 + size * row + col;
+                    uint32 col1 = cells * 1 + size * row + value;
+                    uint32 col2 = cells * 2 + size * col + value;
+                    uint32 col3 = cells * 3 + size * region + value;
+
+                    mrows.push_back(RowDescriptor(row, col, value, renumbered[col0],
+                        renumbered[col1], renumbered[col2], renumbered[col3]));
                 }
             }
         }
@@ -90,12 +270,24 @@ public:
 
     const SudokuBinaryMatrix& operator=(SudokuBinaryMatrix rhs) {
         std::swap(mrows, rhs.mrows);
+        std::swap(renumbered, rhs.renumbered);
+        mknown = rhs.mknown;
+        placed = rhs.placed;
+        ncols = rhs.ncols;
+        feasible = rhs.feasible;
         return *this;
     }
 
     bool operator()(uint32 row, uint32 col) const {
-        uint16 quarter = col / power<Grid<Row, Col>::size, 2>::value;
-        return mrows[row].cols[quarter] == col;
+        return std::find(nonzero_begin(row), nonzero_end(row), col) != nonzero_end(row);
+    }
+
+    nonzero_iterator nonzero_begin(uint32 row) const {
+        return mrows[row].cols;
+    }
+
+    nonzero_iterator nonzero_end(uint32 row) const {
+        return mrows[row].cols + 4;
     }
 
     const RowDescriptor& operator[](uint32 row) const {
@@ -103,10 +295,95 @@ public:
     }
 
     uint32 rows() const { return mrows.size(); }
-    uint32 cols() const { return power<Grid<Row, Col>::size, 2>::value * 4; }
+    uint32 cols() const { return ncols; }
+
+    // The grid completed by propagation, see propagate().
+    const Grid<Row, Col>& known() const { return mknown; }
+
+    // Whether propagation found out that the grid has no solution.
+    bool infeasible() const { return !feasible; }
 
 private:
     std::vector<RowDescriptor> mrows;
+    std::vector<uint32> renumbered;     // Scratch: matrix column of each column.
+    Grid<Row, Col> mknown;              // Cells known before any search.
+    details::Placed<Row, Col> placed;   // Values placed in mknown.
+    uint32 ncols;                       // Columns left.
+    bool feasible;                      // Whether propagation succeeded.
+};
+
+// Solves any number of grids of a given size on a single cover
+// matrix, built once from the binary matrix of an empty grid. The
+// givens of a grid, along with the cells following from them by
+// propagate(), are forced rows of the search, so solving it only
+// costs covering them and searching, without any rebuild. Prefer it
+// to solve() when solving many grids.
+template <uint16 Row, uint16 Col>
+class Solver {
+public:
+    Solver() : search(full(matrix)) {}
+
+    // Solve a grid, returning an empty grid if it has no solution.
+    Grid<Row, Col> operator()(const Grid<Row, Col>& sudoku) {
+        Grid<Row, Col> solution;
+        if (restart(sudoku) && search.next()) {
+            exact_cover::CoverView cover = search.cover();
+            for (size_t i = 0; i < cover.size(); i++) {
+                Subscript<uint16> cell = matrix[cover[i]].cell;
+                solution(cell.row, cell.col) = matrix[cover[i]].value;
+            }
+        }
+
+        return solution;
+    }
+
+    // Count the solutions of a grid, stopping once limit are found.
+    uint64 count(const Grid<Row, Col>& sudoku,
+                 uint64 limit = std::numeric_limits<uint64>::max()) {
+        uint64 total = 0;
+        if (restart(sudoku)) {
+            while (total < limit && search.next()) {
+                total++;
+            }
+        }
+        return total;
+    }
+
+private:
+    Solver(const Solver&);
+    Solver& operator=(const Solver&);
+
+    // Restart the search with the cells of a grid known after
+    // propagation forced. Returns false if the grid has no solution.
+    bool restart(const Grid<Row, Col>& sudoku) {
+        known = sudoku;
+        if (!propagate(known, placed)) {
+            return false;
+        }
+
+        // Rows of the full matrix are ordered by cell, then value.
+        givens.clear();
+        for (uint16 row = 0; row < Grid<Row, Col>::size; row++) {
+            for (uint16 col = 0; col < Grid<Row, Col>::size; col++) {
+                if (known(row, col).setted()) {
+                    givens.push_back((uint32(row) * Grid<Row, Col>::size + col) *
+                                     Grid<Row, Col>::size + known(row, col).get());
+                }
+            }
+        }
+        return search.restart(givens);
+    }
+
+    static const SudokuBinaryMatrix<Row, Col>& full(SudokuBinaryMatrix<Row, Col>& matrix) {
+        matrix << Grid<Row, Col>();
+        return matrix;
+    }
+
+    SudokuBinaryMatrix<Row, Col> matrix;    // Every candidate of every cell.
+    exact_cover::Search search;             // Search over the full matrix.
+    std::vector<uint32> givens;             // Scratch: rows of the known cells.
+    Grid<Row, Col> known;                   // Scratch: the grid once propagated.
+    details::Placed<Row, Col> placed;       // Scratch: values placed in known.
 };
 
 template <uint16 Row, uint16 Col>
@@ -114,9 +391,14 @@ Grid<Row, Col> solve(const Grid<Row, Col>& sudoku) {
     Grid<Row, Col> solution;
     std::vector<uint32> cover;
     SudokuBinaryMatrix<Row, Col> matrix;
+    exact_cover::Arena arena;
 
     matrix << sudoku;
-    cover = exact_cover::solve(matrix);
+    if (!exact_cover::solve(matrix, arena, cover)) {
+        return solution;
+    }
+
+    solution = matrix.known();
     for (size_t i = 0; i < cover.size(); i++) {
         uint32 row = cover[i];
         uint16 value = matrix[row].value;
@@ -127,6 +409,26 @@ Grid<Row, Col> solve(const Grid<Row, Col>& sudoku) {
     return solution;
 }
 
+// Count the solutions of a grid, stopping once limit are found, e.g.
+// a limit of 2 tells whether a grid has a unique solution. Prefer
+// Solver::count() when checking many grids.
+template <uint16 Row, uint16 Col>
+uint64 count_solutions(const Grid<Row, Col>& sudoku,
+                       uint64 limit = std::numeric_limits<uint64>::max()) {
+    SudokuBinaryMatrix<Row, Col> matrix;
+    exact_cover::Arena arena;
+
+    matrix << sudoku;
+    return exact_cover::count(matrix, arena, limit);
+}
+
+// Whether a grid has exactly one solution. The search
+// stops as soon as a second solution is found.
+template <uint16 Row, uint16 Col>
+bool is_unique(const Grid<Row, Col>& sudoku) {
+    return count_solutions(sudoku, 2) == 1;
+}
+
 } // namespace sudoku
 
 #endif /* SUDOKU_SOLVER_HPP_ */
@@ -18,15 +18,73 @@
 #include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <random>
 #include <vector>
 
 #include "mapped_matrix.hpp"
 #include "exact_cover.hpp"
+#include "fixtures.hpp"
 
 using namespace std;
 
+// Hides the nonzero iteration of a matrix so that
+// the cover matrix is built by dense probing.
+template <typename Matrix>
+class DenseMatrix {
+public:
+    DenseMatrix(const Matrix& matrix) : matrix(matrix) {}
+
+    bool operator()(uint32 row, uint32 col) const {
+        return matrix(row, col) != 0;
+    }
+
+    uint32 rows() const { return matrix.rows(); }
+    uint32 cols() const { return matrix.cols(); }
+
+private:
+    const Matrix& matrix;
+};
+
+// Declares its primary columns through an inherited member.
+template <typename Matrix>
+class DerivedColumns : public exact_cover::PrimaryColumns<Matrix> {
+public:
+    DerivedColumns(const Matrix& matrix, uint32 primary) :
+        exact_cover::PrimaryColumns<Matrix>(matrix, primary) {}
+};
+
+// Declares its primary columns as some other integer type.
+template <typename Matrix>
+class WidePrimaryColumns : public DenseMatrix<Matrix> {
+public:
+    WidePrimaryColumns(const Matrix& matrix, size_t primary) :
+        DenseMatrix<Matrix>(matrix), primary(primary) {}
+
+    size_t primary_cols() const { return primary; }
+
+private:
+    size_t primary;
+};
+
+// Records every solution it is handed, up to a limit.
+class Collector {
+public:
+    Collector(vector<vector<uint32> >& solutions, size_t limit) :
+        solutions(solutions), limit(limit) {}
+
+    bool operator()(const exact_cover::CoverView& cover) {
+        solutions.push_back(vector<uint32>(cover.begin(), cover.end()));
+        sort(solutions.back().begin(), solutions.back().end());
+        return solutions.size() < limit;
+    }
+
+private:
+    vector<vector<uint32> >& solutions;
+    size_t limit;
+};
+
 int main() {
-    vector<size_t> cover;
+    vector<uint32> cover;
 
     MappedMatrix<int> m1(2, 2);
     m1(0, 0) = 1;
@@ -41,5 +99,314 @@ int main() {
     cover = exact_cover::solve(m2);
     assert(cover.empty());
 
+    // An arena can be reused across solves, whatever the
+    // size of the instances it successively holds.
+    exact_cover::Arena arena;
+    assert(exact_cover::solve(m1, arena, cover));
+    assert(cover.size() == 2);
+    assert(!exact_cover::solve(m2, arena, cover));
+    assert(cover.empty());
+
+    MappedMatrix<int> m3(3, 3);
+    m3(0, 0) = 1;
+    m3(0, 1) = 1;
+    m3(1, 1) = 1;
+    m3(1, 2) = 1;
+    m3(2, 2) = 1;
+    assert(exact_cover::solve(m3, arena, cover));
+    assert(cover.size() == 2);
+    assert(find(cover.begin(), cover.end(), 0) != cover.end());
+    assert(find(cover.begin(), cover.end(), 2) != cover.end());
+    assert(exact_cover::solve(m1, arena, cover));
+    assert(cover.size() == 2);
+
+    // The compact engine should agree with the default one.
+    exact_cover::CompactArena compact;
+    assert(exact_cover::solve(m3, compact, cover));
+    assert(cover.size() == 2);
+    assert(find(cover.begin(), cover.end(), 0) != cover.end());
+    assert(find(cover.begin(), cover.end(), 2) != cover.end());
+    assert(!exact_cover::solve(m2, compact, cover));
+    assert(cover.empty());
+    cover = exact_cover::solve<exact_cover::CompactArena>(m1);
+    assert(cover.size() == 2);
+
+    // Knuth's example from the Dancing Links paper, whose
+    // only solution is made of rows 0, 3 and 4.
+    MappedMatrix<int> m4 = knuth();
+
+    cover = exact_cover::solve(m4);
+    sort(cover.begin(), cover.end());
+    assert(cover.size() == 3);
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+
+    cover = exact_cover::solve<exact_cover::CompactArena>(m4);
+    sort(cover.begin(), cover.end());
+    assert(cover.size() == 3);
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+
+    // So should the bit-parallel engine.
+    exact_cover::BitsetArena bitset;
+    assert(exact_cover::solve(m4, bitset, cover));
+    sort(cover.begin(), cover.end());
+    assert(cover.size() == 3);
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+    assert(!exact_cover::solve(m2, bitset, cover));
+    assert(cover.empty());
+    assert(exact_cover::solve(m3, bitset, cover));
+    assert(cover.size() == 2);
+    assert(!exact_cover::solve(MappedMatrix<int>(0, 2), bitset, cover));
+    assert(exact_cover::solve(MappedMatrix<int>(0, 0), bitset, cover));
+    assert(cover.empty());
+
+    // Matrices without nonzero iteration are probed densely.
+    assert(!exact_cover::details::is_sparse<DenseMatrix<MappedMatrix<int> > >::value);
+    assert(exact_cover::details::is_sparse<MappedMatrix<int> >::value);
+    cover = exact_cover::solve(DenseMatrix<MappedMatrix<int> >(m4));
+    sort(cover.begin(), cover.end());
+    assert(cover.size() == 3);
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+
+    // Enumeration should visit every solution, once.
+    vector<vector<uint32> > solutions;
+    assert(exact_cover::enumerate(m4, Collector(solutions, 10)));
+    assert(solutions.size() == 1);
+    assert(solutions[0].size() == 3);
+
+    MappedMatrix<int> m5 = three_covers();
+
+    solutions.clear();
+    assert(exact_cover::enumerate(m5, arena, Collector(solutions, 10)));
+    sort(solutions.begin(), solutions.end());
+    assert(solutions.size() == 3);
+    assert(solutions[0].size() == 2);
+    assert(solutions[0][0] == 0 && solutions[0][1] == 1);
+    assert(solutions[1].size() == 2);
+    assert(solutions[1][0] == 0 && solutions[1][1] == 3);
+    assert(solutions[2].size() == 1);
+    assert(solutions[2][0] == 2);
+
+    // The visitor can stop the enumeration.
+    solutions.clear();
+    assert(!exact_cover::enumerate(m5, arena, Collector(solutions, 2)));
+    assert(solutions.size() == 2);
+
+    solutions.clear();
+    assert(exact_cover::enumerate(m2, arena, Collector(solutions, 10)));
+    assert(solutions.empty());
+
+    // Counting should agree with enumeration, up to the limit.
+    assert(exact_cover::count(m4) == 1);
+    assert(exact_cover::count(m5) == 3);
+    assert(exact_cover::count(m5, arena) == 3);
+    assert(exact_cover::count(m5, arena, 2) == 2);
+    assert(exact_cover::count(m5, 0) == 0);
+    assert(exact_cover::count(m2) == 0);
+
+    // A search can be suspended after each solution and
+    // restarts once every solution has been produced.
+    exact_cover::Search search(m5, arena);
+    for (int pass = 0; pass < 2; pass++) {
+        solutions.clear();
+        while (search.next()) {
+            exact_cover::CoverView view = search.cover();
+            solutions.push_back(vector<uint32>(view.begin(), view.end()));
+        }
+        assert(solutions.size() == 3);
+        assert(search.cover().size() == 0);
+    }
+
+    // Every column selection policy should find the same covers.
+    assert(exact_cover::count(m4, arena, 10, exact_cover::FirstColumn()) == 1);
+    assert(exact_cover::count(m5, arena, 10, exact_cover::FirstColumn()) == 3);
+    for (uint64 seed = 0; seed < 8; seed++) {
+        exact_cover::RandomizedMinimumRemainingValues policy(seed);
+        assert(exact_cover::count(m5, arena, 10, policy) == 3);
+        assert(exact_cover::solve(m4, arena, cover, policy));
+        sort(cover.begin(), cover.end());
+        assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+    }
+
+    exact_cover::BucketedMinimumRemainingValues buckets;
+    assert(exact_cover::count(m4, arena, 10, buckets) == 1);
+    assert(exact_cover::count(m5, arena, 10, buckets) == 3);
+    assert(exact_cover::count(m2, arena, 10, buckets) == 0);
+    assert(exact_cover::solve(m4, arena, cover, buckets));
+    sort(cover.begin(), cover.end());
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+
+    vector<uint32> priorities(7, 1);
+    priorities[6] = 100;
+    exact_cover::WeightedMinimumRemainingValues weighted(priorities);
+    exact_cover::BasicSearch<exact_cover::WeightedMinimumRemainingValues>
+        weighted_search(m4, arena, weighted);
+    assert(weighted_search.next());
+    assert(weighted_search.cover().size() == 3);
+    assert(!weighted_search.next());
+
+    // With first column branching, the search
+    // starts with the first row of column 0.
+    exact_cover::BasicSearch<exact_cover::FirstColumn> first(m5, arena);
+    assert(first.next());
+    assert(first.cover()[0] == 0);
+
+    // Secondary columns may be left uncovered.
+    uint64 queens_counts[] = { 1, 0, 0, 2, 10, 4, 40, 92 };
+    for (uint32 n = 1; n <= 8; n++) {
+        MappedMatrix<int> board = queens(n);
+        assert(exact_cover::count(board) == 0 || n == 1);
+        assert(exact_cover::count(exact_cover::primary_columns(board, 2 * n)) ==
+               queens_counts[n - 1]);
+        assert(exact_cover::count(exact_cover::primary_columns(board, 2 * n),
+                   arena, 1000, buckets) == queens_counts[n - 1]);
+        assert(exact_cover::count(exact_cover::primary_columns(
+                   DenseMatrix<MappedMatrix<int> >(board), 2 * n)) ==
+               queens_counts[n - 1]);
+        assert(exact_cover::count(DerivedColumns<MappedMatrix<int> >(board, 2 * n)) ==
+               queens_counts[n - 1]);
+        assert(exact_cover::count(WidePrimaryColumns<MappedMatrix<int> >(board, 2 * n)) ==
+               queens_counts[n - 1]);
+
+        cover = exact_cover::solve<exact_cover::CompactArena>(
+            exact_cover::primary_columns(board, 2 * n));
+        assert(cover.size() == (queens_counts[n - 1] > 0 ? n : 0));
+
+        cover = exact_cover::solve<exact_cover::BitsetArena>(
+            exact_cover::primary_columns(board, 2 * n));
+        assert(cover.size() == (queens_counts[n - 1] > 0 ? n : 0));
+    }
+
+    // Restarting a search with forced rows, possibly in the middle
+    // of the enumeration, restores the cover matrix beforehand.
+    exact_cover::Arena forced_arena;
+    exact_cover::Search forced_search(m5, forced_arena);
+    vector<uint32> forced(1, 0);
+    assert(forced_search.next());
+    assert(forced_search.restart(forced));
+    assert(forced_search.next());
+    assert(forced_search.cover()[0] == 0 && forced_search.cover().size() == 2);
+    assert(forced_search.next());
+    assert(!forced_search.next());
+    forced[0] = 2;
+    assert(forced_search.restart(forced));
+    assert(forced_search.next());
+    assert(forced_search.cover().size() == 1);
+    assert(!forced_search.next());
+    forced.push_back(0);
+    assert(!forced_search.restart(forced));
+    assert(!forced_search.next());
+    assert(forced_search.restart());
+    for (int i = 0; i < 3; i++) {
+        assert(forced_search.next());
+    }
+    assert(!forced_search.next());
+
+    // Statistics describe the search tree. On Knuth's example, the
+    // first row tried at the root leads to a dead end at depth 2.
+    exact_cover::SearchStats stats;
+    assert(exact_cover::solve(m4, arena, cover, exact_cover::MinimumRemainingValues(), stats));
+    assert(stats.nodes == 6 && stats.max_depth == 3);
+    assert(stats.profile.size() == 4);
+    assert(stats.profile[0] == 1 && stats.profile[1] == 2);
+    assert(stats.profile[2] == 2 && stats.profile[3] == 1);
+    assert(stats.updates == 43);
+
+    // Every update is undone once the search is over.
+    assert(exact_cover::count(m5, arena, 10, exact_cover::FirstColumn(), stats) == 3);
+    assert(stats.updates % 2 == 0);
+    uint64 nodes = 0;
+    for (size_t depth = 0; depth < stats.profile.size(); depth++) {
+        nodes += stats.profile[depth];
+    }
+    assert(nodes == stats.nodes && stats.profile[0] == 1);
+
+    // A search stops once its budget runs out, which is told apart
+    // from the absence of solution.
+    exact_cover::Budget budget;
+    exact_cover::FirstColumn leftmost;
+    assert(exact_cover::solve_within(m4, arena, cover, budget) == exact_cover::SOLVED);
+    assert(exact_cover::solve_within(m4, arena, cover, budget, leftmost) == exact_cover::SOLVED);
+    assert(exact_cover::solve_within(m2, arena, cover, budget) == exact_cover::UNSOLVABLE);
+    budget.node_limit(3);
+    assert(exact_cover::solve_within(m4, arena, cover, budget) == exact_cover::EXHAUSTED);
+    assert(cover.empty());
+    budget.node_limit(6);
+    assert(exact_cover::solve_within(m4, arena, cover, budget) == exact_cover::SOLVED);
+
+    // So does it once cancelled or past its deadline, and
+    // the cover matrix is restored for the next search.
+    MappedMatrix<int> ten = queens(10);
+    exact_cover::Search ten_search(exact_cover::primary_columns(ten, 20), arena);
+    std::atomic<bool> cancelled(true);
+    ten_search.limit(exact_cover::Budget().cancellation(cancelled));
+    assert(!ten_search.next() && ten_search.exhausted());
+    ten_search.limit(exact_cover::Budget().deadline(
+        exact_cover::Budget::clock::now() - std::chrono::seconds(1)));
+    assert(!ten_search.next() && ten_search.exhausted());
+    ten_search.limit(exact_cover::Budget());
+    uint64 total = 0;
+    while (ten_search.next()) {
+        total++;
+    }
+    assert(total == 724 && !ten_search.exhausted());
+
+    // Eight queens with a queen on a corner.
+    MappedMatrix<int> board = queens(8);
+    exact_cover::Search queens_search(exact_cover::primary_columns(board, 16), arena);
+    for (int pass = 0; pass < 2; pass++) {
+        for (total = 0; queens_search.next(); total++) {}
+        assert(total == 92);
+        assert(queens_search.restart(vector<uint32>(1, 0)));
+        for (total = 0; queens_search.next(); total++) {}
+        assert(total == 4);
+        queens_search.restart();
+    }
+
+    // The decision diagram holds every cover, once.
+    exact_cover::ZDD zdd = exact_cover::decision_diagram(m5);
+    assert(zdd.count() == 3);
+    solutions.clear();
+    for (uint64 rank = 0; rank < 3; rank++) {
+        assert(zdd.cover(rank, cover));
+        sort(cover.begin(), cover.end());
+        solutions.push_back(cover);
+    }
+    assert(!zdd.cover(3, cover));
+    sort(solutions.begin(), solutions.end());
+    assert(solutions[0].size() == 2 && solutions[0][0] == 0 && solutions[0][1] == 1);
+    assert(solutions[1].size() == 2 && solutions[1][0] == 0 && solutions[1][1] == 3);
+    assert(solutions[2].size() == 1 && solutions[2][0] == 2);
+    assert(exact_cover::decision_diagram(m2).count() == 0);
+    assert(exact_cover::decision_diagram(MappedMatrix<int>(0, 0)).count() == 1);
+
+    exact_cover::decision_diagram(m4, arena, zdd, exact_cover::FirstColumn());
+    assert(zdd.count() == 1);
+    std::mt19937_64 generator(1);
+    assert(zdd.sample(generator, cover));
+    sort(cover.begin(), cover.end());
+    assert(cover.size() == 3);
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+
+    for (uint32 n = 1; n <= 8; n++) {
+        exact_cover::decision_diagram(exact_cover::primary_columns(queens(n), 2 * n),
+                                      arena, zdd, exact_cover::MinimumRemainingValues());
+        assert(zdd.count() == queens_counts[n - 1]);
+    }
+
+    // Identical subproblems are solved once, so that counting
+    // the tilings of a board doesn't visit each of them.
+    exact_cover::decision_diagram(dominoes(60), arena, zdd,
+                                  exact_cover::BucketedMinimumRemainingValues());
+    assert(zdd.count() == 2504730781961ULL);
+    assert(zdd.size() < 200);
+    assert(zdd.sample(generator, cover));
+    assert(cover.size() == 60);
+    assert(exact_cover::count(dominoes(10)) == 89);
+
+    exact_cover::Search empty(MappedMatrix<int>(0, 0));
+    assert(empty.next());
+    assert(empty.cover().size() == 0);
+    assert(!empty.next());
+
     return 0;
 }
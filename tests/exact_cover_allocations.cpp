@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "mapped_matrix.hpp"
+#include "exact_cover.hpp"
+#include "fixtures.hpp"
+
+using namespace std;
+
+// Heap allocations made so far, through operator new.
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* block = malloc(size == 0 ? 1 : size);
+    if (block == 0) {
+        throw bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+int main() {
+    MappedMatrix<int> m4 = knuth();
+
+    // Once an arena and a cover have grown to fit an instance,
+    // solving it again doesn't touch the heap.
+    exact_cover::Arena arena;
+    vector<uint32> cover;
+    assert(exact_cover::solve(m4, arena, cover));
+
+    size_t before = allocations;
+    for (int i = 0; i < 3; i++) {
+        assert(exact_cover::solve(m4, arena, cover));
+        assert(cover.size() == 3);
+    }
+    assert(allocations == before);
+
+    // Neither does restarting a search with as many forced
+    // rows as before, whether they are compatible or not.
+    vector<uint32> forced;
+    forced.push_back(3);
+    forced.push_back(4);
+    exact_cover::Search search(m4, arena);
+    assert(search.restart(forced) && search.next());
+    before = allocations;
+    assert(search.restart(forced) && search.next());
+    assert(search.cover().size() == 3);
+    forced[1] = 1;
+    assert(!search.restart(forced) && !search.next());
+    assert(allocations == before);
+
+    // Rows out of the matrix are rejected.
+    forced.assign(1, 6);
+    assert(!search.restart(forced) && !search.next());
+    forced.assign(1, 0xFFFFFFFFu);
+    assert(!search.restart(forced) && !search.next());
+    forced.clear();
+    assert(search.restart(forced) && search.next());
+    return 0;
+}
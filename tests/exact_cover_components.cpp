@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "mapped_matrix.hpp"
+#include "exact_cover.hpp"
+#include "exact_cover_components.hpp"
+#include "fixtures.hpp"
+
+using namespace std;
+
+// Lay out copies of an instance along the diagonal, which makes
+// an instance whose components are the copies.
+MappedMatrix<int> copies(const MappedMatrix<int>& block, uint32 n) {
+    MappedMatrix<int> matrix(block.rows() * n, block.cols() * n);
+    for (uint32 k = 0; k < n; k++) {
+        for (uint32 row = 0; row < block.rows(); row++) {
+            for (uint32 col = 0; col < block.cols(); col++) {
+                if (block(row, col)) {
+                    matrix(k * block.rows() + row, k * block.cols() + col) = 1;
+                }
+            }
+        }
+    }
+    return matrix;
+}
+
+// Counts the covers it is handed, up to a limit,
+// checking that none of them repeats a row.
+struct Checker {
+    Checker(uint64& total, uint64 limit) : total(total), limit(limit) {}
+
+    bool operator()(const exact_cover::CoverView& cover) {
+        vector<uint32> rows(cover.begin(), cover.end());
+        sort(rows.begin(), rows.end());
+        assert(unique(rows.begin(), rows.end()) == rows.end());
+        return ++total < limit;
+    }
+
+    uint64& total;
+    uint64 limit;
+};
+
+int main() {
+    // Three covers: rows 0 and 1, rows 0 and 3, or row 2.
+    MappedMatrix<int> m5 = three_covers();
+
+    MappedMatrix<int> instance = copies(m5, 12);
+    vector<exact_cover::Component> parts;
+    exact_cover::components(instance, parts);
+    assert(parts.size() == 12);
+    for (size_t i = 0; i < parts.size(); i++) {
+        assert(parts[i].rows() == 4 && parts[i].cols() == 2);
+        assert(parts[i].origin[0] % 4 == 0);
+    }
+
+    assert(exact_cover::count_components(instance) == 531441);
+    assert(exact_cover::count_components(instance, 3) == 531441);
+
+    vector<uint32> cover;
+    assert(exact_cover::solve_components(instance, cover));
+    assert(cover.size() >= 12 && cover.size() <= 24);
+    vector<bool> covered(instance.cols(), false);
+    for (size_t i = 0; i < cover.size(); i++) {
+        for (uint32 col = 0; col < instance.cols(); col++) {
+            if (instance(cover[i], col)) {
+                assert(!covered[col]);
+                covered[col] = true;
+            }
+        }
+    }
+    assert(count(covered.begin(), covered.end(), true) == 24);
+
+    uint64 total = 0;
+    assert(exact_cover::enumerate_components(copies(m5, 4), Checker(total, 1000)));
+    assert(total == 81);
+    total = 0;
+    assert(exact_cover::enumerate_components(copies(m5, 4), Checker(total, 1000), 2));
+    assert(total == 81);
+    total = 0;
+    assert(!exact_cover::enumerate_components(instance, Checker(total, 1000)));
+    assert(total == 1000);
+    total = 0;
+    assert(!exact_cover::enumerate_components(instance, Checker(total, 1000), 1));
+    assert(total == 1000);
+
+    // A component without cover leaves the whole instance without.
+    MappedMatrix<int> m2(2, 2);
+    m2(0, 1) = 1;
+    m2(1, 1) = 1;
+    assert(exact_cover::count_components(m2) == 0);
+    assert(!exact_cover::solve_components(m2, cover) && cover.empty());
+    assert(!exact_cover::solve_components(m2, cover, 1) && cover.empty());
+    total = 0;
+    assert(exact_cover::enumerate_components(m2, Checker(total, 10)));
+    assert(exact_cover::enumerate_components(m2, Checker(total, 10), 1));
+    assert(total == 0);
+
+    // Splitting again after some choices doesn't change the covers,
+    // and neither do secondary columns.
+    uint64 queens_counts[] = { 1, 0, 0, 2, 10, 4, 40, 92 };
+    for (uint32 n = 1; n <= 8; n++) {
+        MappedMatrix<int> board = queens(n);
+        exact_cover::PrimaryColumns<MappedMatrix<int> > problem =
+            exact_cover::primary_columns(board, 2 * n);
+        assert(exact_cover::count_components(problem) == queens_counts[n - 1]);
+        assert(exact_cover::count_components(problem, 2) == queens_counts[n - 1]);
+
+        total = 0;
+        assert(exact_cover::enumerate_components(problem, Checker(total, 1000), 2));
+        assert(total == queens_counts[n - 1]);
+
+        bool solved = exact_cover::solve_components(problem, cover, 2);
+        assert(solved == (queens_counts[n - 1] > 0));
+        assert(cover.size() == (solved ? n : 0));
+        vector<uint32> ranks(n, 0);
+        for (size_t i = 0; i < cover.size(); i++) {
+            ranks[cover[i] / n]++;
+        }
+        assert(!solved || count(ranks.begin(), ranks.end(), 1u) == n);
+    }
+
+    // The empty instance has a single, empty, cover.
+    assert(exact_cover::count_components(MappedMatrix<int>(0, 0)) == 1);
+    assert(exact_cover::solve_components(MappedMatrix<int>(0, 0), cover));
+    assert(cover.empty());
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+#include "mapped_matrix.hpp"
+#include "exact_cover.hpp"
+#include "exact_cover_file.hpp"
+#include "fixtures.hpp"
+
+using namespace std;
+
+bool throws(const char* path) {
+    try {
+        exact_cover::InstanceFile instance(path);
+    } catch (const runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    const char* path = "exact_cover_file.xcov";
+
+    // An instance read back from a file is the same binary
+    // matrix, secondary columns included.
+    MappedMatrix<int> board = queens(8);
+    exact_cover::write_instance(exact_cover::primary_columns(board, 16), path);
+    {
+        exact_cover::InstanceFile instance(path);
+        assert(instance.rows() == 64 && instance.cols() == 46);
+        assert(instance.primary_cols() == 16);
+        assert(instance.nonzeros() == 256);
+        for (uint32 row = 0; row < board.rows(); row++) {
+            for (uint32 col = 0; col < board.cols(); col++) {
+                assert(instance(row, col) == (board(row, col) != 0));
+            }
+        }
+        assert(exact_cover::count(instance) == 92);
+    }
+
+    MappedMatrix<int> empty(0, 0);
+    exact_cover::write_instance(empty, path);
+    {
+        exact_cover::InstanceFile instance(path);
+        assert(instance.rows() == 0 && instance.cols() == 0);
+        assert(exact_cover::count(instance) == 1);
+    }
+
+    // Files which aren't instances are rejected.
+    assert(throws("no such file.xcov"));
+
+    FILE* file = fopen(path, "wb");
+    fputs("not an instance, though long enough for a header", file);
+    fclose(file);
+    assert(throws(path));
+
+    // So are truncated ones.
+    exact_cover::write_instance(board, path);
+    vector<char> bytes(4096);
+    file = fopen(path, "rb");
+    size_t length = fread(&bytes[0], 1, bytes.size(), file);
+    fclose(file);
+    file = fopen(path, "wb");
+    fwrite(&bytes[0], 1, length - 4, file);
+    fclose(file);
+    assert(throws(path));
+
+    // And ones whose counts only add up to the size of the file
+    // once their sizes overflow, which would send reads past it.
+    uint32 rows = 1 << 28;
+    uint64 nonzeros = (uint64(1) << 62) - 2 * uint64(rows) + 384;
+    memcpy(&bytes[8], &rows, sizeof(rows));
+    memcpy(&bytes[24], &nonzeros, sizeof(nonzeros));
+    file = fopen(path, "wb");
+    fwrite(&bytes[0], 1, length, file);
+    fclose(file);
+    assert(throws(path));
+
+    // And ones with a row running past the nonzeros, even though
+    // the next row starts back within them, which would send reads
+    // past the end of a file of a whole page.
+    exact_cover::details::FileHeader header;
+    memcpy(header.magic, exact_cover::details::file_magic, sizeof(header.magic));
+    header.version = exact_cover::details::file_version;
+    header.rows = 2;
+    header.cols = 100000;
+    header.primary = header.cols;
+    header.reserved = 0;
+    header.nonzeros = (4096 - sizeof(header) - 3 * sizeof(uint64)) / sizeof(uint32);
+    uint64 starts[3] = { 0, 50000, header.nonzeros };
+    vector<uint32> increasing(header.nonzeros);
+    for (uint32 i = 0; i < increasing.size(); i++) {
+        increasing[i] = i;
+    }
+    file = fopen(path, "wb");
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(starts, sizeof(uint64), 3, file);
+    fwrite(&increasing[0], sizeof(uint32), increasing.size(), file);
+    fclose(file);
+    assert(throws(path));
+
+    // And ones whose rows repeat a column or list them out of order,
+    // which would be searched as other matrices.
+    exact_cover::write_instance(board, path);
+    file = fopen(path, "rb");
+    length = fread(&bytes[0], 1, bytes.size(), file);
+    fclose(file);
+    size_t first = sizeof(exact_cover::details::FileHeader) + 65 * sizeof(uint64);
+    vector<char> repeated(bytes.begin(), bytes.begin() + length);
+    memcpy(&repeated[first + 4], &repeated[first], 4);
+    file = fopen(path, "wb");
+    fwrite(&repeated[0], 1, length, file);
+    fclose(file);
+    assert(throws(path));
+
+    vector<char> swapped(bytes.begin(), bytes.begin() + length);
+    memcpy(&swapped[first], &bytes[first + 4], 4);
+    memcpy(&swapped[first + 4], &bytes[first], 4);
+    file = fopen(path, "wb");
+    fwrite(&swapped[0], 1, length, file);
+    fclose(file);
+    assert(throws(path));
+
+    remove(path);
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+#include "sudoku.hpp"
+#include "mapped_matrix.hpp"
+#include "sudoku_solver_ng.hpp"
+#include "exact_cover_parallel.hpp"
+
+using namespace std;
+
+// Records the solutions it is handed, up to a limit.
+class Collector {
+public:
+    Collector(vector<vector<uint32> >& covers, size_t limit) :
+        covers(covers), limit(limit) {}
+
+    bool operator()(const exact_cover::CoverView& cover) {
+        assert(cover.size() > 0);
+        covers.push_back(vector<uint32>(cover.begin(), cover.end()));
+        sort(covers.back().begin(), covers.back().end());
+        return covers.size() < limit;
+    }
+
+private:
+    vector<vector<uint32> >& covers;
+    size_t limit;
+};
+
+// Tells whether the rows of a cover hold each column exactly once.
+template <typename Matrix>
+bool exact(const Matrix& matrix, const vector<uint32>& cover) {
+    for (uint32 col = 0; col < matrix.cols(); col++) {
+        size_t covering = 0;
+        for (size_t i = 0; i < cover.size(); i++) {
+            covering += matrix(cover[i], col) != 0;
+        }
+        if (covering != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tells whether covers are exact and pairwise distinct.
+template <typename Matrix>
+bool distinct(const Matrix& matrix, vector<vector<uint32> > covers) {
+    for (size_t i = 0; i < covers.size(); i++) {
+        if (!exact(matrix, covers[i])) {
+            return false;
+        }
+    }
+    sort(covers.begin(), covers.end());
+    return unique(covers.begin(), covers.end()) == covers.end();
+}
+
+int main() {
+    MappedMatrix<int> m1(4, 2);
+    m1(0, 0) = 1;
+    m1(1, 1) = 1;
+    m1(2, 0) = m1(2, 1) = 1;
+    m1(3, 1) = 1;
+
+    MappedMatrix<int> m2(2, 2);
+    m2(0, 1) = 1;
+    m2(1, 1) = 1;
+
+    // Every 4x4 grid is a solution of the empty 2x2 Sudoku.
+    sudoku::Grid<2, 2> empty;
+    sudoku::SudokuBinaryMatrix<2, 2> m3;
+    m3 << empty;
+
+    for (size_t threads = 1; threads <= 8; threads++) {
+        assert(exact_cover::parallel::count(m1, threads) == 3);
+        assert(exact_cover::parallel::count(m2, threads) == 0);
+        assert(exact_cover::parallel::count(m3, threads) == 288);
+        assert(exact_cover::parallel::count(m3, threads,
+                   exact_cover::RandomizedMinimumRemainingValues(threads)) == 288);
+        assert(exact_cover::parallel::count(m3, threads,
+                   exact_cover::BucketedMinimumRemainingValues()) == 288);
+
+        vector<uint32> cover = exact_cover::parallel::solve(m3, threads);
+        assert(cover.size() == 16 && exact(m3, cover));
+        assert(exact_cover::parallel::solve(m2, threads).empty());
+
+        vector<vector<uint32> > covers;
+        assert(exact_cover::parallel::enumerate(m3, Collector(covers, 1000), threads));
+        assert(covers.size() == 288 && distinct(m3, covers));
+
+        covers.clear();
+        assert(!exact_cover::parallel::enumerate(m3, Collector(covers, 10), threads));
+        assert(covers.size() == 10 && distinct(m3, covers));
+    }
+
+    return 0;
+}
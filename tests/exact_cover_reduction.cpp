@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "mapped_matrix.hpp"
+#include "exact_cover.hpp"
+#include "exact_cover_reduction.hpp"
+#include "fixtures.hpp"
+
+using namespace std;
+
+int main() {
+    vector<uint32> cover;
+    exact_cover::Arena arena;
+    exact_cover::ReductionReport report;
+
+    // Knuth's example is solved by the reduction alone: column 0
+    // is included in column 3, which drops row 5, after which
+    // every column left has a single row.
+    MappedMatrix<int> m4 = knuth();
+
+    exact_cover::Reduction core(m4);
+    assert(!core.infeasible());
+    assert(core.rows() == 0 && core.cols() == 0);
+    assert(core.report().forced_rows == 3);
+    assert(core.report().removed_rows == 3);
+    assert(core.report().removed_cols == 7);
+
+    assert(exact_cover::solve_reduced(m4, arena, cover, report));
+    sort(cover.begin(), cover.end());
+    assert(cover.size() == 3);
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+    assert(report.forced_rows == 3 && report.passes >= 1);
+
+    // An empty primary column makes the instance infeasible.
+    MappedMatrix<int> m2(2, 2);
+    m2(0, 1) = 1;
+    m2(1, 1) = 1;
+    assert(exact_cover::Reduction(m2).infeasible());
+    assert(!exact_cover::solve_reduced(m2, arena, cover, report));
+    assert(report.infeasible && cover.empty());
+
+    // So do forced rows conflicting with each other.
+    MappedMatrix<int> m6(2, 3);
+    m6(0, 0) = m6(0, 1) = 1;
+    m6(1, 1) = m6(1, 2) = 1;
+    assert(exact_cover::Reduction(m6).infeasible());
+
+    // Rows the reduction can't settle are left to the search, in
+    // a core with as many covers as the instance.
+    MappedMatrix<int> m5 = three_covers();
+    exact_cover::Reduction undecided(m5);
+    assert(undecided.rows() == 4 && undecided.forced().empty());
+    assert(exact_cover::count(undecided) == 3);
+
+    uint64 queens_counts[] = { 1, 0, 0, 2, 10, 4, 40, 92 };
+    for (uint32 n = 1; n <= 8; n++) {
+        MappedMatrix<int> board = queens(n);
+        exact_cover::Reduction reduced(exact_cover::primary_columns(board, 2 * n));
+        assert(exact_cover::count(reduced) == queens_counts[n - 1]);
+
+        bool solved = exact_cover::solve_reduced(exact_cover::primary_columns(board, 2 * n),
+                                                 arena, cover, report);
+        assert(solved == (queens_counts[n - 1] > 0));
+        assert(cover.size() == (solved ? n : 0));
+    }
+
+    return 0;
+}
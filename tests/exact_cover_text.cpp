@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "exact_cover.hpp"
+#include "exact_cover_text.hpp"
+
+using namespace std;
+
+bool rejected(const string& text) {
+    istringstream in(text);
+    try {
+        exact_cover::TextInstance instance(in);
+    } catch (const runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    // Knuth's example from the Dancing Links paper.
+    istringstream knuth("| Knuth's example\n"
+                        "A B C D E F G\n"
+                        "C E F\n"
+                        "A D G\n"
+                        "B C F\n"
+                        "\n"
+                        "A D\n"
+                        "B G\n"
+                        "D E G\n");
+    exact_cover::TextInstance instance(knuth);
+    assert(instance.rows() == 6 && instance.cols() == 7);
+    assert(instance.primary_cols() == 7);
+    assert(instance.name(6) == "G");
+    assert(instance(1, 0) && instance(1, 3) && instance(1, 6) && !instance(1, 1));
+    assert(instance.line(3) == 7);
+    assert(instance.text(5) == "D E G");
+
+    vector<uint32> cover = exact_cover::solve(instance);
+    sort(cover.begin(), cover.end());
+    assert(cover.size() == 3);
+    assert(cover[0] == 0 && cover[1] == 3 && cover[2] == 4);
+
+    // Columns after the bar are secondary.
+    istringstream secondary("a b | x y\n"
+                            "a x\n"
+                            "b x\n"
+                            "b y\n"
+                            "a\n");
+    exact_cover::TextInstance optional(secondary);
+    assert(optional.cols() == 4 && optional.primary_cols() == 2);
+    assert(exact_cover::count(optional) == 3);
+
+    assert(rejected(""));
+    assert(rejected("| only comments\n"));
+    assert(rejected("a b\na c\n"));
+    assert(rejected("a b\na a\n"));
+    assert(rejected("a b a\na\n"));
+    assert(rejected("a | b\na b:red\n"));
+    assert(!rejected("a b\n"));
+
+    return 0;
+}
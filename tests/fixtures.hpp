@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef TESTS_FIXTURES_HPP_
+#define TESTS_FIXTURES_HPP_
+
+#include "types.hpp"
+#include "mapped_matrix.hpp"
+
+// Exact cover instances shared by the tests and the benchmarks.
+
+// Knuth's example from the Dancing Links paper, whose
+// only solution is made of rows 0, 3 and 4.
+inline MappedMatrix<int> knuth() {
+    MappedMatrix<int> matrix(6, 7);
+    matrix(0, 2) = matrix(0, 4) = matrix(0, 5) = 1;
+    matrix(1, 0) = matrix(1, 3) = matrix(1, 6) = 1;
+    matrix(2, 1) = matrix(2, 2) = matrix(2, 5) = 1;
+    matrix(3, 0) = matrix(3, 3) = 1;
+    matrix(4, 1) = matrix(4, 6) = 1;
+    matrix(5, 3) = matrix(5, 4) = matrix(5, 6) = 1;
+    return matrix;
+}
+
+// Three covers: rows 0 and 1, rows 0 and 3, or row 2.
+inline MappedMatrix<int> three_covers() {
+    MappedMatrix<int> matrix(4, 2);
+    matrix(0, 0) = 1;
+    matrix(1, 1) = 1;
+    matrix(2, 0) = matrix(2, 1) = 1;
+    matrix(3, 1) = 1;
+    return matrix;
+}
+
+// Encode the n-queens problem: a row per square, covering its rank
+// and file, which are primary columns, and its two diagonals, which
+// are secondary columns since they may stay free.
+inline MappedMatrix<int> queens(uint32 n) {
+    MappedMatrix<int> matrix(n * n, 6 * n - 2);
+    for (uint32 rank = 0; rank < n; rank++) {
+        for (uint32 file = 0; file < n; file++) {
+            uint32 row = rank * n + file;
+            matrix(row, rank) = 1;
+            matrix(row, n + file) = 1;
+            matrix(row, 2 * n + rank + file) = 1;
+            matrix(row, 4 * n - 1 + n - 1 - rank + file) = 1;
+        }
+    }
+    return matrix;
+}
+
+// Encode the domino tilings of a 2 by n board: a row per domino,
+// covering its two squares. There are Fibonacci many tilings.
+inline MappedMatrix<int> dominoes(uint32 n) {
+    MappedMatrix<int> matrix(3 * n - 2, 2 * n);
+    uint32 row = 0;
+    for (uint32 file = 0; file < n; file++) {
+        matrix(row, file) = matrix(row, n + file) = 1;
+        row++;
+    }
+    for (uint32 file = 0; file + 1 < n; file++) {
+        matrix(row, file) = matrix(row, file + 1) = 1;
+        row++;
+        matrix(row, n + file) = matrix(row, n + file + 1) = 1;
+        row++;
+    }
+    return matrix;
+}
+
+#endif // TESTS_FIXTURES_HPP_
@@ -104,5 +104,22 @@ int main() {
     assert(m5(1, 0) == 3);
     assert(m5(1, 1) == 4);
 
+    // Iteration over the nonzeros of a row should only
+    // yield the columns of the nonzero elements.
+    MappedMatrix<int> m6(2, 4);
+    m6(0, 3) = 1;
+    m6(0, 1) = 2;
+    m6(0, 2) = 3;
+    m6(0, 2) = int();
+
+    MappedMatrix<int>::nonzero_iterator iter = m6.nonzero_begin(0);
+    assert(iter != m6.nonzero_end(0));
+    assert(*iter == 1);
+    ++iter;
+    assert(*iter == 3);
+    ++iter;
+    assert(iter == m6.nonzero_end(0));
+    assert(m6.nonzero_begin(1) == m6.nonzero_end(1));
+
     return 0;
 }
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <sstream>
+#include <cassert>
+#include <string>
+
+#include "sudoku.hpp"
+#include "sudoku_batch.hpp"
+
+using namespace std;
+using namespace sudoku;
+
+const string puzzle =
+    "x0x25xx4xxx1xxxxxxx4xx803xx76xxxxxxx4xx5x7xx6xxxxxxx80xx803xx5xxxxxxx6xxx7xx64x2x";
+const string solution =
+    "307256841851473062246180375762308514480517236513642780628031457134725608075864123";
+const string blanks(81, 'x');
+
+// Solutions come out in the order of the puzzles, whatever the
+// number of threads and the size of the chunks.
+void test_order(size_t threads, size_t chunk_size) {
+    // The second puzzle is the first one with a value less, in
+    // upper case; the third has two zeros in its first row.
+    string second = puzzle;
+    second[1] = 'X';
+    string conflicting = blanks;
+    conflicting[0] = conflicting[1] = '0';
+
+    stringstream in;
+    stringstream out;
+    for (int i = 0; i < 3; i++) {
+        in << puzzle << "\n" << second << "\r\n" << conflicting << "\n"
+           << "short\n" << string(80, 'x') << "?\n";
+    }
+
+    BatchReport report = solve_batch<3, 3>(in, out, threads, chunk_size);
+    assert(report.puzzles == 15);
+    assert(report.solved == 6);
+    assert(report.unsolvable == 3);
+    assert(report.malformed == 6);
+
+    string line;
+    for (int i = 0; i < 3; i++) {
+        getline(out, line); assert(line == solution);
+        getline(out, line); assert(line == solution);
+        getline(out, line); assert(line == blanks);
+        getline(out, line); assert(line == blanks);
+        getline(out, line); assert(line == blanks);
+    }
+    assert(!getline(out, line));
+}
+
+// Lines too long to be a puzzle are skipped without being read
+// whole, and the lines which follow them are still puzzles.
+void test_long_lines() {
+    stringstream in;
+    stringstream out;
+    in << string(100000, 'x') << "\n" << puzzle << "x\n" << puzzle << "\r\n"
+       << puzzle << "\n\n" << string(1000, 'x');
+
+    BatchReport report = solve_batch<3, 3>(in, out, 2, 2);
+    assert(report.puzzles == 6);
+    assert(report.solved == 2);
+    assert(report.malformed == 4);
+    assert(out.str() == blanks + "\n" + blanks + "\n" + solution + "\n" +
+                        solution + "\n" + blanks + "\n" + blanks + "\n");
+
+    // A last puzzle without line break is read all the same.
+    stringstream last(puzzle);
+    out.str("");
+    report = solve_batch<3, 3>(last, out, 1);
+    assert(report.puzzles == 1 && report.solved == 1);
+    assert(out.str() == solution + "\n");
+}
+
+int main() {
+    test_order(1, 4096);
+    test_order(3, 1);
+    test_order(4, 4);
+    test_long_lines();
+
+    stringstream empty;
+    stringstream out;
+    BatchReport report = solve_batch<3, 3>(empty, out, 2);
+    assert(report.puzzles == 0);
+    assert(out.str().empty());
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <cassert>
+#include <vector>
+
+#include "sudoku.hpp"
+#include "sudoku_generator.hpp"
+#include "sudoku_validation.hpp"
+
+using namespace std;
+using namespace sudoku;
+
+// A minimal puzzle has a unique solution, lost
+// as soon as any of its givens is removed.
+template <uint16 Row, uint16 Col>
+bool minimal(const Grid<Row, Col>& puzzle) {
+    if (!is_unique(puzzle)) {
+        return false;
+    }
+    for (uint16 row = 0; row < Grid<Row, Col>::size; row++) {
+        for (uint16 col = 0; col < Grid<Row, Col>::size; col++) {
+            if (puzzle(row, col).setted()) {
+                Grid<Row, Col> fewer = puzzle;
+                fewer(row, col).reset();
+                if (is_unique(fewer)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template <uint16 Row, uint16 Col>
+void test_generator(uint64 seed) {
+    Generator<Row, Col> generator(seed);
+
+    Grid<Row, Col> full = generator.full_grid();
+    assert(valid(full));
+    assert(count_solutions(full) == 1);
+
+    Grid<Row, Col> puzzle = generator.minimize(full);
+    assert(minimal(puzzle));
+    assert(solve(puzzle) == full);
+
+    // Different draws give different grids.
+    assert(generator.full_grid() != full || generator.full_grid() != full);
+}
+
+// Puzzles only depend on the seed and their index.
+void test_generate() {
+    vector<Grid<3, 3> > puzzles;
+    vector<Grid<3, 3> > others;
+    generate(puzzles, 6, 7, 1);
+    generate(others, 6, 7, 3);
+
+    assert(puzzles.size() == 6);
+    assert(puzzles == others);
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        assert(minimal(puzzles[i]));
+    }
+    assert(puzzles[0] != puzzles[1]);
+}
+
+int main() {
+    test_generator<2, 2>(1);
+    test_generator<2, 2>(2);
+    test_generator<3, 3>(3);
+    test_generate();
+    return 0;
+}
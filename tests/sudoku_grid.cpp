@@ -15,15 +15,103 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <stdexcept>
 #include <iostream>
 #include <cassert>
+#include <cstring>
+#include <string>
 
 #include "sudoku.hpp"
 
 using namespace std;
 using namespace sudoku;
 
+void test_parse() {
+    Grid<2, 2> grid;
+    const char* text = "x3 1" "0XxX" "xx01" "xx2x";
+    assert(grid.parse(text, 16) == PARSED);
+    assert(grid(0, 1) == 3 && grid(0, 3) == 1 && grid(1, 0) == 0);
+    assert(!grid(0, 0).setted() && !grid(0, 2).setted() && !grid(1, 1).setted());
+
+    char formatted[17] = { 0 };
+    assert(grid.format(formatted, 15) == 0);
+    assert(grid.format(formatted, 16) == 16);
+    assert(string(formatted) == "x3x10xxxxx01xx2x");
+
+    assert(grid.parse(text, 15) == BAD_LENGTH);
+    assert(grid.parse("xxxxxxxxxxxxxxx4", 16) == BAD_CHARACTER);
+    assert(grid.parse("xxxxxxxxxxxxxxx.", 16) == BAD_CHARACTER);
+
+    Grid<4, 4> large;
+    assert(large.parse(string(255, 'x').append("F").data(), 256) == PARSED);
+    assert(large(15, 15) == 15);
+
+    // The string operator throws instead.
+    bool thrown = false;
+    try {
+        grid << "xxxxxxxxxxxxxxx4";
+    } catch (const logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void test_parse_records() {
+    Grid<2, 2> grids[4];
+    ParseStatus status[4];
+    size_t consumed = 0;
+
+    // Back to back, then on lines, with a short line and a line
+    // break left at the end, then an unterminated line.
+    const char* text = "0123xxxxxxxxxxxx" "xxxx3xxxxxxxxxxx\r\n"
+                       "x1\n" "\n" "xxxxxxxxxxxxxxx9\n" "0123";
+    size_t length = strlen(text);
+
+    assert(parse_records(text, length, grids, status, 4, &consumed) == 4);
+    assert(status[0] == PARSED && grids[0](0, 3) == 3);
+    assert(status[1] == PARSED && grids[1](1, 0) == 3);
+    assert(status[2] == BAD_LENGTH);
+    assert(status[3] == BAD_CHARACTER);
+    assert(consumed == length - 5);
+
+    // Once records run out, so does the parsing.
+    assert(parse_records(text + consumed, length - consumed, grids, status, 4, &consumed) == 0);
+    assert(consumed == 1);
+    assert(parse_records(text, length, grids, status, 2, &consumed) == 2);
+    assert(consumed == 32);
+
+    // Once the input is known to end, so does the last line.
+    assert(parse_records(text + length - 4, 4, grids, status, 4, &consumed, true) == 1);
+    assert(status[0] == BAD_LENGTH && consumed == 4);
+    assert(parse_records(text + 16, 17, grids, status, 4, &consumed, true) == 1);
+    assert(status[0] == PARSED && grids[0](1, 0) == 3 && consumed == 17);
+
+    // A line one character too long is a single bad record,
+    // and the next line still makes the next record.
+    Grid<3, 3> large[3];
+    string lines = string(82, 'x') + "\n" + string(80, 'x') + "0\n";
+    assert(parse_records(lines.data(), lines.size(), large, status, 3, &consumed) == 2);
+    assert(status[0] == BAD_LENGTH);
+    assert(status[1] == PARSED && large[1](8, 8) == 0);
+    assert(consumed == lines.size());
+
+    // A buffer cut within a line leaves the line to the next call,
+    // which reads the same records as a single call.
+    size_t first = parse_records(lines.data(), 81, large, status, 3, &consumed);
+    assert(first == 0 && consumed == 0);
+    assert(parse_records(lines.data(), lines.size(), large, status, 3, &consumed, true) == 2);
+    assert(status[0] == BAD_LENGTH && status[1] == PARSED);
+
+    // Back to back records on a line of their own are read as such.
+    lines = string(162, 'x') + "\r\n";
+    assert(parse_records(lines.data(), lines.size(), large, status, 3) == 2);
+    assert(status[0] == PARSED && status[1] == PARSED);
+}
+
 int main() {
+    test_parse();
+    test_parse_records();
+
     Grid<2, 2> sudoku;
 
     sudoku << "xxxx"
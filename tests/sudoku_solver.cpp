@@ -114,7 +114,7 @@ void test_3x3() {
     assert(solve(instance) == solution);
 }
 
-int test_4x4() {
+void test_4x4() {
     Grid<4, 4> instance;
     Grid<4, 4> solution;
 
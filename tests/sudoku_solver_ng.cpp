@@ -20,6 +20,7 @@
 
 #include "sudoku.hpp"
 #include "sudoku_solver_ng.hpp"
+#include "sudoku_validation.hpp"
 
 using namespace std;
 using namespace sudoku;
@@ -136,7 +137,7 @@ void test_3x3() {
     assert(solve(instance) == solution);
 }
 
-int test_4x4() {
+void test_4x4() {
     Grid<4, 4> instance;
     Grid<4, 4> solution;
 
@@ -177,6 +178,138 @@ int test_4x4() {
     assert(solve(instance) == solution);
 }
 
+// A solver reused across grids finds the same solutions.
+void test_solver() {
+    Solver<3, 3> solver;
+    Grid<3, 3> instance;
+    Grid<3, 3> empty;
+
+    instance << "x0x25xx4x"
+                "xx1xxxxxx"
+                "x4xx803xx"
+                "76xxxxxxx"
+                "4xx5x7xx6"
+                "xxxxxxx80"
+                "xx803xx5x"
+                "xxxxxx6xx"
+                "x7xx64x2x";
+
+    assert(solver(instance) == solve(instance));
+    assert(solver(empty) == solve(empty));
+    assert(solver(instance) == solve(instance));
+
+    instance << "x00xxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx";
+
+    assert(solver(instance) == empty);
+}
+
+// Singles fill easy grids before any search, and only the cells they
+// leave out make it into the binary matrix of harder ones.
+void test_propagation() {
+    Grid<3, 3> instance;
+    Grid<3, 3> solution;
+    SudokuBinaryMatrix<3, 3> matrix;
+
+    instance << "x0x25xx4x"
+                "xx1xxxxxx"
+                "x4xx803xx"
+                "76xxxxxxx"
+                "4xx5x7xx6"
+                "xxxxxxx80"
+                "xx803xx5x"
+                "xxxxxx6xx"
+                "x7xx64x2x";
+
+    solution = instance;
+    assert(propagate(solution));
+    assert(solution == solve(instance));
+
+    matrix << instance;
+    assert(!matrix.infeasible());
+    assert(matrix.rows() == 0 && matrix.cols() == 0);
+    assert(matrix.known() == solution);
+
+    // Givens of a hard grid settle nothing more: the matrix only lacks
+    // their cells and the values they place, 24 givens out of 81.
+    instance << "0xxxx6x8x"
+                "x2xx1xxx7"
+                "xx85xx4xx"
+                "xx42xx8xx"
+                "x0xx7xxx1"
+                "5xxxx3xxx"
+                "2xxxxxx0x"
+                "x3xxxxxx6"
+                "xx6xxx2xx";
+
+    matrix << instance;
+    assert(matrix.cols() == 4 * (81 - 24));
+    assert(matrix.rows() < 9 * (81 - 24));
+    for (uint32 row = 0; row < matrix.rows(); row++) {
+        assert(!instance(matrix[row].cell.row, matrix[row].cell.col).setted());
+    }
+    assert(valid(solve(instance)));
+
+    // A value with no room left in the first row.
+    instance << "xxxxxx012"
+                "xxx3xxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "xxxxxxxxx"
+                "x3xxxxxxx"
+                "xx3xxxxxx"
+                "3xxxxxxxx";
+
+    matrix << instance;
+    assert(matrix.infeasible() && matrix.rows() == 0);
+    assert(solve(instance) == (Grid<3, 3>()));
+}
+
+// Counting stops at the limit, which is enough to tell unique grids.
+void test_count() {
+    Solver<2, 2> small;
+    Grid<2, 2> empty;
+    assert(count_solutions(empty) == 288);
+    assert(count_solutions(empty, 10) == 10);
+    assert(small.count(empty) == 288);
+    assert(!is_unique(empty));
+
+    Solver<3, 3> solver;
+    Grid<3, 3> instance;
+    instance << "0xxxx6x8x"
+                "x2xx1xxx7"
+                "xx85xx4xx"
+                "xx42xx8xx"
+                "x0xx7xxx1"
+                "5xxxx3xxx"
+                "2xxxxxx0x"
+                "x3xxxxxx6"
+                "xx6xxx2xx";
+
+    assert(count_solutions(instance) == 1);
+    assert(is_unique(instance));
+    assert(solver.count(instance) == 1);
+
+    // Without its first given, the grid has several solutions.
+    instance(0, 0).reset();
+    assert(count_solutions(instance, 2) == 2);
+    assert(!is_unique(instance));
+    assert(solver.count(instance, 2) == 2);
+    assert(solver.count(instance) == count_solutions(instance));
+
+    instance(0, 0) = 5;
+    assert(count_solutions(instance) == 0);
+    assert(solver.count(instance) == 0);
+}
+
 void test_5x5() {
     Grid<5, 5> sudoku;
     solve(sudoku);
@@ -191,6 +324,9 @@ int main() {
     test_2x2();
     test_3x3();
     test_4x4();
+    test_solver();
+    test_propagation();
+    test_count();
     test_5x5();
     test_6x6();
     return 0;
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+// Solve an exact cover instance given in the text format of Knuth's
+// DLX programs, see TextInstance, read from a file or the standard
+// input. Solutions are printed on the standard output, one row per
+// line followed by an empty line, and the time spent parsing the
+// instance, building its cover matrix, searching it and printing the
+// solutions is reported on the standard error.
+
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <limits>
+#include <string>
+
+#include "types.hpp"
+#include "exact_cover.hpp"
+#include "exact_cover_text.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock timer;
+
+static double elapsed(timer::time_point start) {
+    return chrono::duration<double, milli>(timer::now() - start).count();
+}
+
+static int usage() {
+    cerr << "usage: dlx [options] [file]\n"
+            "  -c, --count      count the solutions instead of printing them\n"
+            "  -a, --all        print every solution instead of the first one\n"
+            "  -n, --limit N    stop after N solutions\n";
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    bool counting = false;
+    uint64 limit = 1;
+    const char* path = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--count")) {
+            counting = true;
+            limit = numeric_limits<uint64>::max();
+        } else if (!strcmp(argv[i], "-a") || !strcmp(argv[i], "--all")) {
+            limit = numeric_limits<uint64>::max();
+        } else if ((!strcmp(argv[i], "-n") || !strcmp(argv[i], "--limit")) && i + 1 < argc) {
+            limit = strtoull(argv[++i], 0, 10);
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            return usage();
+        } else if (path == 0) {
+            path = argv[i];
+        } else {
+            return usage();
+        }
+    }
+
+    timer::time_point start = timer::now();
+    unique_ptr<exact_cover::TextInstance> instance;
+    try {
+        if (path == 0 || !strcmp(path, "-")) {
+            instance.reset(new exact_cover::TextInstance(cin));
+        } else {
+            ifstream file(path);
+            if (!file) {
+                cerr << "dlx: can't open " << path << "\n";
+                return 2;
+            }
+            instance.reset(new exact_cover::TextInstance(file));
+        }
+    } catch (const runtime_error& e) {
+        cerr << "dlx: " << e.what() << "\n";
+        return 2;
+    }
+    double parsing = elapsed(start);
+
+    start = timer::now();
+    exact_cover::Search search(*instance);
+    double building = elapsed(start);
+
+    // Time spent printing solutions isn't counted as search.
+    start = timer::now();
+    uint64 solutions = 0;
+    double printing = 0;
+    while (solutions < limit && search.next()) {
+        solutions++;
+        if (!counting) {
+            timer::time_point printed = timer::now();
+            exact_cover::CoverView cover = search.cover();
+            for (size_t i = 0; i < cover.size(); i++) {
+                cout << instance->text(cover[i]) << "\n";
+            }
+            cout << "\n";
+            printing += elapsed(printed);
+        }
+    }
+    double searching = elapsed(start) - printing;
+
+    if (counting) {
+        cout << solutions << "\n";
+    } else if (solutions == 0) {
+        cout << "no solution\n";
+    }
+
+    cerr << instance->rows() << " rows, " << instance->cols() << " columns ("
+         << instance->primary_cols() << " primary), " << solutions << " solutions\n"
+         << "parse: " << parsing << " ms, build: " << building
+         << " ms, search: " << searching << " ms, print: " << printing << " ms\n";
+
+    return counting || solutions > 0 ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2011 Mathieu Turcotte (mathieuturcotte.ca)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+// Solve 9x9 sudokus, one per line of a file or the standard input,
+// see sudoku::solve_batch(). Solutions are printed on the standard
+// output in the same order and the throughput is reported on the
+// standard error. Alternatively, generate minimal puzzles, see
+// sudoku::generate(), printed one per line the same way.
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+#include "types.hpp"
+#include "sudoku_batch.hpp"
+#include "sudoku_generator.hpp"
+
+using namespace std;
+
+static int usage() {
+    cerr << "usage: sudoku [options] [file]\n"
+            "  -t, --threads N  solve with N threads\n"
+            "  -c, --chunk N    read N puzzles at a time\n"
+            "  -g, --generate N generate N minimal puzzles instead\n"
+            "  -s, --seed N     seed of the generated puzzles\n";
+    return 2;
+}
+
+static int generate(size_t count, uint64 seed, size_t threads) {
+    typedef chrono::steady_clock timer;
+    timer::time_point start = timer::now();
+    vector<sudoku::Grid<3, 3> > puzzles;
+    sudoku::generate(puzzles, count, seed, threads);
+    double seconds = chrono::duration<double>(timer::now() - start).count();
+
+    uint64 givens = 0;
+    char line[82];
+    line[81] = '\n';
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        puzzles[i].format(line, 81);
+        cout.write(line, sizeof(line));
+        givens += 81 - std::count(line, line + 81, 'x');
+    }
+    cout.flush();
+
+    cerr << count << " puzzles, " << (count ? double(givens) / count : 0) << " givens on average\n"
+         << seconds << " s, " << (seconds > 0 ? count / seconds : 0) << " puzzles/s\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    size_t threads = thread::hardware_concurrency();
+    size_t chunk_size = 4096;
+    size_t generated = 0;
+    uint64 seed = 1;
+    const char* path = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threads")) && i + 1 < argc) {
+            threads = strtoul(argv[++i], 0, 10);
+        } else if ((!strcmp(argv[i], "-c") || !strcmp(argv[i], "--chunk")) && i + 1 < argc) {
+            chunk_size = strtoul(argv[++i], 0, 10);
+        } else if ((!strcmp(argv[i], "-g") || !strcmp(argv[i], "--generate")) && i + 1 < argc) {
+            generated = strtoul(argv[++i], 0, 10);
+        } else if ((!strcmp(argv[i], "-s") || !strcmp(argv[i], "--seed")) && i + 1 < argc) {
+            seed = strtoull(argv[++i], 0, 10);
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            return usage();
+        } else if (path == 0) {
+            path = argv[i];
+        } else {
+            return usage();
+        }
+    }
+
+    ios::sync_with_stdio(false);
+    if (generated > 0) {
+        return generate(generated, seed, threads);
+    }
+
+    sudoku::BatchReport report;
+    if (path == 0 || !strcmp(path, "-")) {
+        report = sudoku::solve_batch<3, 3>(cin, cout, threads, chunk_size);
+    } else {
+        ifstream file(path);
+        if (!file) {
+            cerr << "sudoku: can't open " << path << "\n";
+            return 2;
+        }
+        report = sudoku::solve_batch<3, 3>(file, cout, threads, chunk_size);
+    }
+    cout.flush();
+
+    cerr << report.puzzles << " puzzles, " << report.solved << " solved, "
+         << report.unsolvable << " unsolvable, " << report.malformed << " malformed\n"
+         << report.seconds << " s, " << report.puzzles_per_second() << " puzzles/s\n";
+
+    return report.solved == report.puzzles ? 0 : 1;
+}